@@ -0,0 +1,126 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "Benchmark.h"
+#include "Json.h"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+namespace
+{
+	std::string s_Filter;
+	std::vector<BenchmarkResult> s_Results;
+
+	/* Just enough JSON for the files writeBenchmarkJson() makes: a "name" string followed by a "best_ns"
+	 * number in every object */
+	std::unordered_map<std::string, double> readBaseline(const std::string& text)
+	{
+		std::unordered_map<std::string, double> baseline;
+		size_t position = 0;
+		while((position = text.find("\"name\"", position)) != std::string::npos)
+		{
+			position = text.find('"', text.find(':', position));
+			if(position == std::string::npos)
+				break;
+			std::string name;
+			for(position++; position < text.size() && text[position] != '"'; position++)
+			{
+				if(text[position] == '\\' && position + 1 < text.size())
+					position++;
+				name += text[position];
+			}
+
+			const size_t best = text.find("\"best_ns\"", position);
+			if(best == std::string::npos)
+				break;
+			baseline[name] = std::strtod(text.c_str() + text.find(':', best) + 1, nullptr);
+			position = best;
+		}
+		return baseline;
+	}
+}
+
+void setBenchmarkFilter(std::string filter)
+{
+	s_Filter = std::move(filter);
+}
+
+bool isBenchmarkSelected(const char* name)
+{
+	return s_Filter.empty() || std::string_view(name).find(s_Filter) != std::string_view::npos;
+}
+
+void addBenchmarkResult(BenchmarkResult result)
+{
+	s_Results.push_back(std::move(result));
+}
+
+const std::vector<BenchmarkResult>& getBenchmarkResults()
+{
+	return s_Results;
+}
+
+bool writeBenchmarkJson(const std::string& filePath)
+{
+	std::ofstream file(filePath);
+	if(!file)
+	{
+		std::cout << "can't write '" << filePath << "'" << std::endl;
+		return false;
+	}
+
+	file << std::setprecision(6) << "{\n  \"benchmarks\": [";
+	for(size_t i = 0; i < s_Results.size(); i++)
+	{
+		const BenchmarkResult& result = s_Results[i];
+		file << (i ? ",\n    " : "\n    ") << "{\"name\": ";
+		writeJsonString(file, result.name);
+		file << ", \"best_ns\": " << result.bestNs << ", \"median_ns\": " << result.medianNs
+			 << ", \"iterations\": " << result.iterations << "}";
+	}
+	file << "\n  ]\n}\n";
+	std::cout << "wrote " << s_Results.size() << " results to '" << filePath << "'" << std::endl;
+	return static_cast<bool>(file);
+}
+
+int compareWithBaseline(const std::string& filePath, double thresholdPercent)
+{
+	std::ifstream file(filePath);
+	if(!file)
+	{
+		std::cout << "can't read the baseline '" << filePath << "'" << std::endl;
+		return -1;
+	}
+	std::stringstream text;
+	text << file.rdbuf();
+	const std::unordered_map<std::string, double> baseline = readBaseline(text.str());
+	if(baseline.empty())
+	{
+		std::cout << "the baseline '" << filePath << "' has no results" << std::endl;
+		return -1;
+	}
+
+	int regressions = 0;
+	std::cout << "\ncompared with " << filePath << " (slower by more than " << thresholdPercent << "% is a regression)" << std::endl;
+	std::cout << std::fixed << std::setprecision(2);
+	for(const BenchmarkResult& result : s_Results)
+	{
+		auto before = baseline.find(result.name);
+		if(before == baseline.end() || before->second <= 0.0)
+		{
+			std::cout << "  " << std::left << std::setw(56) << result.name << std::right << "        new" << std::endl;
+			continue;
+		}
+		const double change = (result.bestNs - before->second) / before->second * 100.0;
+		const bool regressed = change > thresholdPercent;
+		regressions += regressed;
+		std::cout << "  " << std::left << std::setw(56) << result.name << std::right << std::setw(12) << before->second
+				  << " -> " << std::setw(12) << result.bestNs << " ns " << std::showpos << std::setw(8) << change
+				  << std::noshowpos << "%" << (regressed ? "  REGRESSION" : "") << std::endl;
+	}
+	std::cout << std::defaultfloat << regressions << " regression(s)" << std::endl;
+	return regressions;
+}
@@ -0,0 +1,77 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_BENCHMARK_H
+#define OPENGL_THECHERNO_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/* keeps the compiler from throwing away a result we computed only to time it */
+template<class T>
+inline void doNotOptimize(const T& value)
+{
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchmarkResult
+{
+	std::string name;
+	double bestNs; // per call, of the fastest round
+	double medianNs; // per call, of the middle round
+	uint64_t iterations; // per round
+};
+
+/* only benchmarks whose name contains filter run, all of them when it's empty */
+void setBenchmarkFilter(std::string filter);
+bool isBenchmarkSelected(const char* name);
+void addBenchmarkResult(BenchmarkResult result);
+const std::vector<BenchmarkResult>& getBenchmarkResults();
+
+/* {"benchmarks": [{"name": ..., "best_ns": ..., "median_ns": ..., "iterations": ...}, ...]} */
+bool writeBenchmarkJson(const std::string& filePath);
+/* Prints every result next to the one of the same name in a file written by writeBenchmarkJson(), and
+ * returns how many got slower by more than thresholdPercent. -1 when the file can't be read or has no
+ * results, which must fail a run as well: nothing was compared */
+int compareWithBaseline(const std::string& filePath, double thresholdPercent);
+
+/* Runs f() 'iterations' times, a few rounds in a row, and prints the best round in ns per call.
+ * The best round is the one least disturbed by the rest of the machine, it's what the baseline
+ * comparison uses. Returns 0 without running anything when the benchmark isn't selected */
+template<class F>
+double runBenchmark(const char* name, uint64_t iterations, F&& f)
+{
+	if(!isBenchmarkSelected(name))
+		return 0.0;
+
+	using clock = std::chrono::steady_clock;
+	constexpr int rounds = 5;
+	double nsPerCall[rounds];
+	for(int round = 0; round < rounds; round++)
+	{
+		auto start = clock::now();
+		for(uint64_t i = 0; i < iterations; i++)
+			f();
+		std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+		nsPerCall[round] = elapsed.count() / static_cast<double>(iterations);
+	}
+	std::sort(nsPerCall, nsPerCall + rounds);
+
+	const double best = nsPerCall[0];
+	std::cout << name << ": " << best << " ns" << std::endl;
+	addBenchmarkResult({name, best, nsPerCall[rounds / 2], iterations});
+	return best;
+}
+
+void runUniformLookupBenchmarks();
+void runBlockCompressionBenchmarks();
+void runVertexLayoutBenchmarks();
+void runShaderParseBenchmarks();
+void runImageDecodeBenchmarks();
+
+#endif //OPENGL_THECHERNO_BENCHMARK_H
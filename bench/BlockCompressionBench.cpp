@@ -0,0 +1,98 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "Benchmark.h"
+#include "BlockCompression.h"
+#include "Image.h"
+#include <GL/glew.h>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	/* peak signal to noise ratio of the given channels against the original, in dB. Higher is better,
+	 * above 40 is hard to tell apart, the uncompressed upload is the original so it would be infinite */
+	double psnr(const Image& original, const std::vector<unsigned char>& decoded, int firstChannel, int channelCount)
+	{
+		const unsigned char* pixels = original.getPixels();
+		double squaredError = 0.0;
+		for(size_t i = 0; i < original.getSize(); i += 4)
+		{
+			for(int c = firstChannel; c < firstChannel + channelCount; c++)
+			{
+				double difference = static_cast<double>(pixels[i + c]) - decoded[i + c];
+				squaredError += difference * difference;
+			}
+		}
+		double meanSquaredError = squaredError / (static_cast<double>(original.getSize() / 4) * channelCount);
+		if(meanSquaredError == 0.0)
+			return INFINITY;
+		return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+	}
+
+	/* a test card for when the texture isn't there: gradients, hard edges and an alpha ramp */
+	Image makeTestImage()
+	{
+		Image image(512, 512);
+		unsigned char* pixels = image.getPixels();
+		for(int y = 0; y < 512; y++)
+		{
+			for(int x = 0; x < 512; x++)
+			{
+				unsigned char* p = pixels + (y * 512 + x) * 4;
+				bool checker = ((x / 32) + (y / 32)) % 2 == 0;
+				p[0] = static_cast<unsigned char>(x / 2);
+				p[1] = static_cast<unsigned char>(checker ? y / 2 : 255 - y / 2);
+				p[2] = static_cast<unsigned char>((x * y) >> 10);
+				p[3] = static_cast<unsigned char>(x < 256 ? 255 : 511 - x);
+			}
+		}
+		return image;
+	}
+}
+
+void runBlockCompressionBenchmarks()
+{
+	Image image(BENCH_RES_DIR "/textures/pop.png");
+	const char* source = "pop.png";
+	if(!image.isValid())
+	{
+		image = makeTestImage();
+		source = "test image";
+	}
+	const int width = image.getWidth(), height = image.getHeight();
+	const double megapixels = static_cast<double>(width) * height / 1e6;
+	std::cout << "block compression of " << source << " (" << width << "x" << height << ")" << std::endl;
+
+	const struct { const char* name; unsigned int format; } formats[] = {
+		{"bc1", GL_COMPRESSED_RGBA_S3TC_DXT1_EXT},
+		{"bc3", GL_COMPRESSED_RGBA_S3TC_DXT5_EXT},
+	};
+	for(const auto& format : formats)
+	{
+		std::vector<unsigned char> blocks(CompressedImage::getLevelSize(format.format, width, height));
+		std::vector<unsigned char> decoded(image.getSize());
+		std::cout << format.name << ": " << blocks.size() << " bytes instead of " << image.getSize() << std::endl;
+
+		for(BlockEncoder encoder : {BlockEncoder::Scalar, BlockEncoder::SSE2, BlockEncoder::AVX2})
+		{
+			if(!isBlockEncoderSupported(encoder))
+				continue;
+
+			std::string name = std::string(format.name) + " " + getBlockEncoderName(encoder);
+			double ns = runBenchmark(name.c_str(), 3, [&]() {
+				compressLevel(image.getPixels(), width, height, format.format, blocks.data(), encoder);
+				doNotOptimize(blocks[0]);
+			});
+			if(ns == 0.0)
+				continue; // filtered out
+
+			decompressLevel(blocks.data(), width, height, format.format, decoded.data());
+			std::cout << "    " << megapixels / (ns / 1e9) << " Mpixel/s, rgb " << psnr(image, decoded, 0, 3) << " dB";
+			if(format.format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+				std::cout << ", alpha " << psnr(image, decoded, 3, 1) << " dB";
+			std::cout << std::endl;
+		}
+	}
+}
@@ -0,0 +1,50 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "HeadlessContext.h"
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <iostream>
+
+bool createHeadlessContext()
+{
+	auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	EGLDisplay display = getPlatformDisplay ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+			: EGL_NO_DISPLAY;
+	if(display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	EGLint major = 0, minor = 0;
+	if(display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+	{
+		std::cout << "headless context: no EGL display" << std::endl;
+		return false;
+	}
+	eglBindAPI(EGL_OPENGL_API);
+
+	const EGLint attributes[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE};
+	// without a surface there's nothing a config would describe (EGL_KHR_no_config_context)
+	EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+	if(context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+	{
+		std::cout << "headless context: can't make an OpenGL 3.3 core context with EGL (error 0x" << std::hex << eglGetError()
+				  << std::dec << ")" << std::endl;
+		return false;
+	}
+
+	/* our glew is built for GLX: it loads the GL functions and then fails to find a GLX display, which
+	 * we don't need */
+	glewExperimental = GL_TRUE;
+	const GLenum error = glewInit();
+	if(error != GLEW_OK && error != GLEW_ERROR_NO_GLX_DISPLAY)
+	{
+		std::cout << "headless context: glewInit failed, " << glewGetErrorString(error) << std::endl;
+		return false;
+	}
+	glGetError(); // glew asks for GL_EXTENSIONS the old way, which a core context doesn't have
+
+	std::cout << glGetString(GL_RENDERER) << ", OpenGL " << glGetString(GL_VERSION) << std::endl;
+	return true;
+}
@@ -0,0 +1,15 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_HEADLESSCONTEXT_H
+#define OPENGL_THECHERNO_HEADLESSCONTEXT_H
+
+/* Makes an OpenGL 3.3 core context current without a display or window: EGL on Mesa's surfaceless
+ * platform, so it works on a headless machine with llvmpipe (LIBGL_ALWAYS_SOFTWARE=1 makes sure that's
+ * the driver). There's no default framebuffer, draw into a framebuffer object. Prints why and returns
+ * false when there's no such context */
+bool createHeadlessContext();
+
+
+#endif //OPENGL_THECHERNO_HEADLESSCONTEXT_H
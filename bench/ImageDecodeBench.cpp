@@ -0,0 +1,42 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "Benchmark.h"
+#include "Image.h"
+#include "vendor/stb_image/stb_image.h"
+#include <fstream>
+#include <iterator>
+
+void runImageDecodeBenchmarks()
+{
+	const char* filePath = BENCH_RES_DIR "/textures/pop.png";
+	std::ifstream file(filePath, std::ios::binary);
+	if(!file)
+	{
+		std::cout << "image decode: " << filePath << " isn't there, skipped" << std::endl;
+		return;
+	}
+	const std::vector<unsigned char> png((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	int width = 0, height = 0, channels = 0;
+	stbi_info_from_memory(png.data(), static_cast<int>(png.size()), &width, &height, &channels);
+	const double megapixels = static_cast<double>(width) * height / 1e6;
+
+	// just the decoding, the file is already in memory
+	double ns = runBenchmark("image decode: stb_image png from memory, RGBA", 10, [&]() {
+		unsigned char* pixels = stbi_load_from_memory(png.data(), static_cast<int>(png.size()), &width, &height, &channels, 4);
+		doNotOptimize(pixels);
+		stbi_image_free(pixels);
+	});
+	if(ns > 0.0)
+		std::cout << "    " << megapixels / (ns / 1e9) << " Mpixel/s" << std::endl;
+
+	// what the texture loader pays: reading the file, flipping and decoding
+	ns = runBenchmark("image decode: Image from file, RGBA", 10, [&]() {
+		Image image(filePath);
+		doNotOptimize(image.getPixels());
+	});
+	if(ns > 0.0)
+		std::cout << "    " << megapixels / (ns / 1e9) << " Mpixel/s" << std::endl;
+}
@@ -0,0 +1,532 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+/* GPU throughput of whole scenes, drawn through the Renderer, Material and the buffers like the app draws.
+ * Runs without a window: an EGL context on Mesa's surfaceless platform, rendering into a framebuffer object,
+ * so it works on a headless machine with llvmpipe (LIBGL_ALWAYS_SOFTWARE=1 makes sure that's the driver)
+ *
+ *     scene-bench [--filter <text>] [--frames <n>] [--json <file>] [--baseline <file>] [--threshold <percent>]
+ *     scene-bench --golden <directory> [--update-golden] [--tolerance <0-255>] [--max-different <percent>]
+ *
+ * Every frame ends with glFinish(), so a frame time is what the driver took to do the work and not how fast
+ * we could queue it. Each scene prints frames, draws and triangles per second. The results are the same
+ * JSON as the cpu benchmarks (ns per frame), with --baseline the exit code is 1 when a scene lost more
+ * throughput than the threshold (15% unless given, software rendering is noisier than the cpu benchmarks),
+ * and 2 when the baseline can't be read
+ *
+ * With --golden each scene is drawn once instead and compared with <directory>/<scene>.tga. A pixel differs
+ * when a channel is more than the tolerance off (2 unless given), and a scene fails when more than
+ * --max-different percent of its pixels do (none unless given). A failed scene leaves <scene>.actual.tga and
+ * <scene>.diff.tga next to its golden image, and the exit code is 1. --update-golden writes the golden images
+ * instead. They depend on the driver: the ones in bench/golden are llvmpipe's (Mesa 22.3), which ctest checks
+ * exactly (the scene-golden test, --tolerance 0). For another driver make a directory of its own. The pixels
+ * are read back with FramebufferReadback while the next scenes are set up and drawn */
+
+#include "Benchmark.h"
+#include "FramebufferReadback.h"
+#include "HeadlessContext.h"
+#include "Image.h"
+#include "ImageCompare.h"
+#include "IndexBuffer.h"
+#include "Material.h"
+#include "RenderStats.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <memory>
+
+namespace
+{
+	constexpr int TargetSize = 512;
+	constexpr int WarmupFrames = 5;
+
+	const char* vertexSource = R"(#version 330 core
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texCoord;
+out vec2 v_TexCoord;
+uniform vec2 u_Offset;
+void main()
+{
+	gl_Position = vec4(position + u_Offset, 0.0, 1.0);
+	v_TexCoord = texCoord;
+}
+)";
+
+	/* %TINT% is replaced to make the programs of the shader switch scene different programs */
+	const char* fragmentSource = R"(#version 330 core
+layout(location = 0) out vec4 color;
+in vec2 v_TexCoord;
+uniform vec4 u_Color;
+uniform sampler2D u_Texture;
+void main()
+{
+	color = texture(u_Texture, v_TexCoord) * u_Color * %TINT%;
+}
+)";
+
+	/* there's no default framebuffer without a surface, everything is drawn into this */
+	void createTarget()
+	{
+		unsigned int framebuffer = 0, colorBuffer = 0;
+		glCall(glGenFramebuffers(1, &framebuffer));
+		glCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+		glCall(glGenRenderbuffers(1, &colorBuffer));
+		glCall(glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer));
+		glCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, TargetSize, TargetSize));
+		glCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer));
+		glCall(glViewport(0, 0, TargetSize, TargetSize));
+		glCall(glEnable(GL_BLEND));
+		glCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+	}
+
+	std::unique_ptr<Shader> makeShader(int tint)
+	{
+		std::string fragment = fragmentSource;
+		const std::string value = "vec4(vec3(" + std::to_string(1.0f - 0.05f * static_cast<float>(tint)) + "), 1.0)";
+		fragment.replace(fragment.find("%TINT%"), 6, value);
+		return std::make_unique<Shader>("Scene" + std::to_string(tint), vertexSource, fragment);
+	}
+
+	std::unique_ptr<Texture> makeTexture(int size, int seed)
+	{
+		Image image(size, size);
+		unsigned char* pixels = image.getPixels();
+		for(int y = 0; y < size; y++)
+		{
+			for(int x = 0; x < size; x++)
+			{
+				unsigned char* pixel = pixels + (static_cast<size_t>(y) * size + x) * 4;
+				const bool check = ((x / 8) + (y / 8) + seed) % 2;
+				pixel[0] = static_cast<unsigned char>(check ? 255 : seed * 37);
+				pixel[1] = static_cast<unsigned char>(x * 255 / size);
+				pixel[2] = static_cast<unsigned char>(y * 255 / size);
+				pixel[3] = 255;
+			}
+		}
+		return std::make_unique<Texture>(image);
+	}
+
+	/* A vertex array and its buffers. Only the vertex array has to stay alive for drawing, the buffers are
+	 * kept with it because deleting them would take the data along */
+	struct Mesh
+	{
+		std::unique_ptr<VertexBuffer> vertices;
+		std::unique_ptr<IndexBuffer> indices;
+		std::unique_ptr<VertexArray> va;
+	};
+
+	Mesh makeMesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices)
+	{
+		Mesh mesh;
+		mesh.va = std::make_unique<VertexArray>();
+		mesh.vertices = std::make_unique<VertexBuffer>(vertices.data(), static_cast<unsigned int>(vertices.size() * sizeof(float)));
+		VertexBufferLayout layout;
+		layout.push<float>(2);
+		layout.push<float>(2);
+		mesh.va->addBuffer(*mesh.vertices, layout);
+		mesh.indices = std::make_unique<IndexBuffer>(indices.data(), static_cast<unsigned int>(indices.size()));
+		return mesh;
+	}
+
+	/* count quads on a square grid over the target, each 'size' of a cell (1 fills it) */
+	Mesh makeQuads(int count, float size)
+	{
+		const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+		const float cell = 2.0f / static_cast<float>(columns);
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		vertices.reserve(static_cast<size_t>(count) * 16);
+		indices.reserve(static_cast<size_t>(count) * 6);
+		for(int i = 0; i < count; i++)
+		{
+			const float x = -1.0f + cell * static_cast<float>(i % columns), y = -1.0f + cell * static_cast<float>(i / columns);
+			const float w = cell * size;
+			const float quad[] = {x, y, 0.0f, 0.0f, x + w, y, 1.0f, 0.0f, x + w, y + w, 1.0f, 1.0f, x, y + w, 0.0f, 1.0f};
+			vertices.insert(vertices.end(), std::begin(quad), std::end(quad));
+			const unsigned int first = static_cast<unsigned int>(i) * 4;
+			for(unsigned int index : {0u, 1u, 2u, 2u, 3u, 0u})
+				indices.push_back(first + index);
+		}
+		return makeMesh(vertices, indices);
+	}
+
+	/* a columns x rows grid of cells over the whole target, two triangles a cell, all in one index buffer */
+	Mesh makeGrid(int columns, int rows)
+	{
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		vertices.reserve(static_cast<size_t>(columns + 1) * (rows + 1) * 4);
+		indices.reserve(static_cast<size_t>(columns) * rows * 6);
+		for(int y = 0; y <= rows; y++)
+		{
+			for(int x = 0; x <= columns; x++)
+			{
+				const float u = static_cast<float>(x) / static_cast<float>(columns), v = static_cast<float>(y) / static_cast<float>(rows);
+				vertices.insert(vertices.end(), {u * 2.0f - 1.0f, v * 2.0f - 1.0f, u, v});
+			}
+		}
+		for(int y = 0; y < rows; y++)
+		{
+			for(int x = 0; x < columns; x++)
+			{
+				const unsigned int corner = static_cast<unsigned int>(y * (columns + 1) + x), above = corner + columns + 1;
+				for(unsigned int index : {corner, corner + 1, above + 1, above + 1, above, corner})
+					indices.push_back(index);
+			}
+		}
+		return makeMesh(vertices, indices);
+	}
+
+	/* Reads back what a scene drew and checks it against its golden image, or writes the golden image with
+	 * update. The readbacks are collected when they're done, a scene's pixels are usually checked while the
+	 * next scene is drawn */
+	class GoldenImages
+	{
+	private:
+		std::filesystem::path m_Directory;
+		bool m_Update;
+		int m_Tolerance;
+		double m_MaxDifferentPercent;
+		FramebufferReadback m_Readback;
+		std::deque<std::pair<uint64_t, std::string>> m_Pending; // readback id and file name, oldest first
+		int m_Failures;
+	public:
+		GoldenImages(std::filesystem::path directory, bool update, int tolerance, double maxDifferentPercent)
+			: m_Directory(std::move(directory)), m_Update(update), m_Tolerance(tolerance),
+			  m_MaxDifferentPercent(maxDifferentPercent), m_Failures(0)
+		{
+		}
+
+		/* queues a readback of the whole target for the scene */
+		void capture(const char* sceneName)
+		{
+			uint64_t id = m_Readback.request(0, 0, TargetSize, TargetSize);
+			if(id == 0)
+			{
+				// every slot is in flight, the oldest one is done by now or close to it
+				collect(true);
+				id = m_Readback.request(0, 0, TargetSize, TargetSize);
+			}
+			if(id == 0)
+			{
+				std::cout << getFileName(sceneName) << ": FAILED, no readback slot came free" << std::endl;
+				m_Failures++;
+				return;
+			}
+			m_Pending.emplace_back(id, getFileName(sceneName));
+		}
+
+		/* checks the readbacks that are done, with wait all of them */
+		void collect(bool wait)
+		{
+			uint64_t id = 0;
+			Image image;
+			while(!m_Pending.empty() && (wait ? m_Readback.wait(id, image) : m_Readback.collect(id, image)))
+			{
+				// the readbacks come back in order, anything queued before this one has been lost
+				while(!m_Pending.empty() && m_Pending.front().first != id)
+					fail(m_Pending.front().second, "its readback never came back");
+				if(m_Pending.empty())
+					break;
+				const std::string fileName = m_Pending.front().second;
+				m_Pending.pop_front();
+				if(image.isValid())
+					check(fileName, image);
+				else
+				{
+					std::cout << fileName << ": FAILED, its pixels couldn't be read back" << std::endl;
+					m_Failures++;
+				}
+			}
+		}
+
+		/* waits for what's left, returns how many scenes failed. A scene whose readback timed out fails too */
+		int finish()
+		{
+			collect(true);
+			while(!m_Pending.empty())
+				fail(m_Pending.front().second, "its readback timed out");
+			return m_Failures;
+		}
+
+	private:
+		/* "scene: 256 distinct textures" is 256_distinct_textures */
+		static std::string getFileName(std::string name)
+		{
+			if(name.starts_with("scene: "))
+				name.erase(0, 7);
+			for(char& c : name)
+			{
+				if(!std::isalnum(static_cast<unsigned char>(c)))
+					c = '_';
+			}
+			return name;
+		}
+
+		void fail(const std::string& fileName, const char* why)
+		{
+			std::cout << fileName << ": FAILED, " << why << std::endl;
+			m_Pending.pop_front();
+			m_Failures++;
+		}
+
+		void check(const std::string& fileName, const Image& actual)
+		{
+			const std::filesystem::path golden = m_Directory / (fileName + ".tga");
+			if(m_Update)
+			{
+				std::filesystem::create_directories(m_Directory);
+				if(actual.saveTga(golden.string()))
+					std::cout << fileName << ": wrote " << golden.string() << std::endl;
+				else
+					m_Failures++;
+				return;
+			}
+
+			const Image expected(golden.string());
+			if(!expected.isValid())
+			{
+				std::cout << fileName << ": FAILED, no golden image " << golden.string() << " (make it with --update-golden)" << std::endl;
+				m_Failures++;
+				return;
+			}
+			Image diff;
+			const ImageDifference difference = compareImages(expected, actual, m_Tolerance, &diff);
+			const double pixels = static_cast<double>(actual.getWidth()) * actual.getHeight();
+			const double differentPercent = static_cast<double>(difference.differentPixels) * 100.0 / pixels;
+			if(difference.sizeMatches && differentPercent <= m_MaxDifferentPercent)
+			{
+				std::cout << fileName << ": ok (max delta " << difference.maxDelta << ")" << std::endl;
+				return;
+			}
+
+			m_Failures++;
+			if(!difference.sizeMatches)
+			{
+				std::cout << fileName << ": FAILED, golden image is " << expected.getWidth() << "x" << expected.getHeight() << ", scene is "
+						  << actual.getWidth() << "x" << actual.getHeight() << std::endl;
+			}
+			else
+			{
+				std::cout << fileName << ": FAILED, " << difference.differentPixels << " pixels (" << std::fixed << std::setprecision(3)
+						  << differentPercent << "%) differ by more than " << m_Tolerance << ", max delta " << difference.maxDelta
+						  << ", mean " << difference.meanDelta << std::defaultfloat << std::endl;
+				diff.saveTga((m_Directory / (fileName + ".diff.tga")).string());
+			}
+			actual.saveTga((m_Directory / (fileName + ".actual.tga")).string());
+		}
+	};
+
+	/* Draws the scene for warm up frames, then 'frames' timed ones. Reports the frame time like runBenchmark()
+	 * does per call, so that the baseline comparison works on it. With golden images it draws one frame for
+	 * them and nothing is timed */
+	void runScene(const char* name, int frames, Renderer& renderer, GoldenImages* golden, const std::function<void()>& drawFrame)
+	{
+		if(!isBenchmarkSelected(name))
+			return;
+
+		if(golden)
+		{
+			renderer.clear();
+			drawFrame();
+			golden->capture(name);
+			golden->collect(false);
+			return;
+		}
+
+		using clock = std::chrono::steady_clock;
+		std::vector<double> frameNs;
+		FrameStats stats{};
+		for(int frame = 0; frame < WarmupFrames + frames; frame++)
+		{
+			const auto start = clock::now();
+			renderer.clear();
+			drawFrame();
+			glFinish();
+			const std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+			RenderStats::endFrame();
+			stats = RenderStats::getLastFrame();
+			if(frame >= WarmupFrames)
+				frameNs.push_back(elapsed.count());
+		}
+		std::sort(frameNs.begin(), frameNs.end());
+
+		const double best = frameNs.front(), median = frameNs[frameNs.size() / 2];
+		const double fps = 1e9 / median;
+		std::cout << name << ": " << std::fixed << std::setprecision(3) << median / 1e6 << " ms (best " << best / 1e6 << ")"
+				  << std::setprecision(1) << "\n    " << fps << " frames/s, " << std::setprecision(0)
+				  << static_cast<double>(stats.drawCalls) * fps << " draws/s, " << static_cast<double>(stats.triangles) * fps
+				  << " triangles/s" << std::defaultfloat
+				  << std::endl;
+		addBenchmarkResult({name, best, median, static_cast<uint64_t>(frames)});
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* jsonPath = nullptr;
+	const char* baselinePath = nullptr;
+	double threshold = 15.0;
+	int frames = 60;
+	const char* goldenPath = nullptr;
+	bool updateGolden = false;
+	int tolerance = 2;
+	double maxDifferent = 0.0;
+	for(int i = 1; i < argc; i++)
+	{
+		if(std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			jsonPath = argv[++i];
+		else if(std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+			baselinePath = argv[++i];
+		else if(std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+			threshold = std::atof(argv[++i]);
+		else if(std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			setBenchmarkFilter(argv[++i]);
+		else if(std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			frames = std::max(1, std::atoi(argv[++i]));
+		else if(std::strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+			goldenPath = argv[++i];
+		else if(std::strcmp(argv[i], "--update-golden") == 0)
+			updateGolden = true;
+		else if(std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+			tolerance = std::clamp(std::atoi(argv[++i]), 0, 255);
+		else if(std::strcmp(argv[i], "--max-different") == 0 && i + 1 < argc)
+			maxDifferent = std::atof(argv[++i]);
+		else
+		{
+			std::cout << "unknown argument '" << argv[i] << "'" << std::endl;
+			return 2;
+		}
+	}
+	if(updateGolden && !goldenPath)
+	{
+		std::cout << "--update-golden needs --golden <directory>" << std::endl;
+		return 2;
+	}
+
+	if(!createHeadlessContext())
+		return 2;
+	createTarget();
+	Renderer renderer;
+	std::unique_ptr<GoldenImages> golden;
+	if(goldenPath)
+		golden = std::make_unique<GoldenImages>(goldenPath, updateGolden, tolerance, maxDifferent);
+
+	std::vector<std::unique_ptr<Shader>> shaders;
+	for(int i = 0; i < 8; i++)
+		shaders.push_back(makeShader(i));
+	const std::unique_ptr<Texture> texture = makeTexture(256, 0);
+
+	{
+		// one draw of many small quads: vertex and triangle setup, with a little texturing
+		Mesh quads = makeQuads(16384, 0.8f);
+		Material material(*shaders[0]);
+		material.setTexture("u_Texture", 0, *texture);
+		material.setUniform4f("u_Color", 1.0f, 1.0f, 1.0f, 1.0f);
+		material.setUniform2f("u_Offset", 0.0f, 0.0f);
+		runScene("scene: 16384 textured quads, one draw", frames, renderer, golden.get(), [&]() {
+			renderer.draw(*quads.va, *quads.indices, material);
+		});
+	}
+
+	{
+		// a draw per texture, the shader stays bound and only the texture changes
+		Mesh quad = makeQuads(1, 2.0f / 16.0f * 0.9f);
+		std::vector<std::unique_ptr<Texture>> textures;
+		std::vector<Material> materials;
+		materials.reserve(256);
+		for(int i = 0; i < 256; i++)
+		{
+			textures.push_back(makeTexture(64, i));
+			Material& material = materials.emplace_back(*shaders[0]);
+			material.setTexture("u_Texture", 0, *textures.back());
+			material.setUniform4f("u_Color", 1.0f, 1.0f, 1.0f, 1.0f);
+			material.setUniform2f("u_Offset", static_cast<float>(i % 16) / 8.0f, static_cast<float>(i / 16) / 8.0f);
+		}
+		runScene("scene: 256 distinct textures", frames, renderer, golden.get(), [&]() {
+			for(const Material& material : materials)
+				renderer.draw(*quad.va, *quad.indices, material);
+		});
+	}
+
+	{
+		// every draw switches the program, the materials of one program are apart
+		Mesh quad = makeQuads(1, 2.0f / 16.0f * 0.9f);
+		std::vector<Material> materials;
+		materials.reserve(256);
+		for(int i = 0; i < 256; i++)
+		{
+			Material& material = materials.emplace_back(*shaders[i % shaders.size()]);
+			material.setTexture("u_Texture", 0, *texture);
+			material.setUniform4f("u_Color", 1.0f, 1.0f, 1.0f, 1.0f);
+			material.setUniform2f("u_Offset", static_cast<float>(i % 16) / 8.0f, static_cast<float>(i / 16) / 8.0f);
+		}
+		runScene("scene: 256 shader switches", frames, renderer, golden.get(), [&]() {
+			for(const Material& material : materials)
+				renderer.draw(*quad.va, *quad.indices, material);
+		});
+	}
+
+	{
+		// a quarter of a million triangles of about a pixel, from one index buffer
+		Mesh grid = makeGrid(512, 256);
+		Material material(*shaders[0]);
+		material.setTexture("u_Texture", 0, *texture);
+		material.setUniform4f("u_Color", 1.0f, 1.0f, 1.0f, 1.0f);
+		material.setUniform2f("u_Offset", 0.0f, 0.0f);
+		runScene("scene: 256K triangle index buffer", frames, renderer, golden.get(), [&]() {
+			renderer.draw(*grid.va, *grid.indices, material);
+		});
+	}
+
+	{
+		// the same material every draw with new values, so every draw uploads its uniforms again
+		Mesh quad = makeQuads(1, 2.0f / 64.0f * 0.9f);
+		Material material(*shaders[0]);
+		material.setTexture("u_Texture", 0, *texture);
+		runScene("scene: 4096 draws of uniform churn", frames, renderer, golden.get(), [&]() {
+			for(int i = 0; i < 4096; i++)
+			{
+				material.setUniform2f("u_Offset", static_cast<float>(i % 64) / 32.0f, static_cast<float>(i / 64) / 32.0f);
+				material.setUniform4f("u_Color", static_cast<float>(i % 7) / 7.0f, static_cast<float>(i % 5) / 5.0f, 1.0f, 1.0f);
+				renderer.draw(*quad.va, *quad.indices, material);
+			}
+		});
+	}
+
+	if(golden)
+	{
+		const int failures = golden->finish();
+		if(failures > 0)
+		{
+			std::cout << failures << " scenes don't match their golden images" << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	if(jsonPath && !writeBenchmarkJson(jsonPath))
+		return 2;
+	if(baselinePath)
+	{
+		const int regressions = compareWithBaseline(baselinePath, threshold);
+		if(regressions < 0)
+			return 2;
+		if(regressions > 0)
+			return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,44 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "Benchmark.h"
+#include "Shader.h"
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+	/* An uber shader sized file: a vertex and a fragment part of 'lines' lines each, like the
+	 * ones the generated material shaders reach */
+	std::string writeLargeShader(int lines)
+	{
+		const std::string filePath = (std::filesystem::temp_directory_path() / "bench_large.shader").string();
+		std::ofstream file(filePath);
+		file << "// generated by the benchmark\n#shader vertex\n#version 330 core\n";
+		for(int i = 0; i < lines; i++)
+			file << "    vec4 v_Value" << i << " = u_ModelViewProjection * vec4(a_Position.xy, " << i << ".0, 1.0);\n";
+		file << "#shader fragment\n#version 330 core\n";
+		for(int i = 0; i < lines; i++)
+			file << "    color += texture(u_Texture, v_TexCoord + vec2(" << i << ".0 / 4096.0)) * u_Weights[" << i % 16 << "];\n";
+		return filePath;
+	}
+}
+
+void runShaderParseBenchmarks()
+{
+	for(int lines : {100, 10000})
+	{
+		const std::string filePath = writeLargeShader(lines);
+		const double megabytes = static_cast<double>(std::filesystem::file_size(filePath)) / 1e6;
+		const std::string name = "parseShader: " + std::to_string(2 * lines) + " lines";
+
+		const double ns = runBenchmark(name.c_str(), lines > 1000 ? 20 : 2000, [&]() {
+			ShaderProgramSource source = Shader::parseShader(filePath);
+			doNotOptimize(source.vertexSource.size());
+		});
+		if(ns > 0.0)
+			std::cout << "    " << megabytes / (ns / 1e9) << " MB/s" << std::endl;
+		std::filesystem::remove(filePath);
+	}
+}
@@ -0,0 +1,85 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "Benchmark.h"
+#include "UniformTable.h"
+#include <GL/glew.h>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+	/* The location cache Shader used before the uniforms were reflected:
+	 * a std::string is built from the literal on every call, then hashed once by find()
+	 * and once more by operator[] */
+	class StringLocationCache
+	{
+	private:
+		std::unordered_map<std::string, int> m_UniformLocationCache;
+	public:
+		void insert(const std::string& name, int location) { m_UniformLocationCache[name] = location; }
+
+		int getUniformLocation(const std::string& name)
+		{
+			if(m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
+				return m_UniformLocationCache[name];
+			return -1;
+		}
+	};
+
+	// roughly what a material shader has. The names are longer than the small string buffer on purpose
+	const char* const s_Names[] = {
+		"u_Color", "u_Texture", "u_ModelViewProjection", "u_NormalMatrix", "u_LightDirection",
+		"u_LightColorAndIntensity", "u_CameraWorldPosition", "u_RoughnessMetallicOcclusion"
+	};
+	constexpr unsigned int s_NameCount = sizeof(s_Names) / sizeof(s_Names[0]);
+}
+
+void runUniformLookupBenchmarks()
+{
+	StringLocationCache cache;
+	UniformTable table;
+	for(unsigned int i = 0; i < s_NameCount; i++)
+	{
+		cache.insert(s_Names[i], static_cast<int>(i));
+		table.add(s_Names[i], static_cast<int>(i), GL_FLOAT_VEC4, 1);
+	}
+
+	constexpr uint64_t iterations = 10000000;
+	unsigned int n = 0;
+
+	runBenchmark("uniform lookup: string cache (old Shader)", iterations, [&]() {
+		doNotOptimize(cache.getUniformLocation("u_ModelViewProjection"));
+	});
+
+	runBenchmark("uniform lookup: string cache, rotating names", iterations, [&]() {
+		doNotOptimize(cache.getUniformLocation(s_Names[n++ % s_NameCount]));
+	});
+
+	runBenchmark("uniform lookup: table, runtime hashed name", iterations, [&]() {
+		doNotOptimize(table.find(std::string_view(s_Names[n++ % s_NameCount])));
+	});
+
+	runBenchmark("uniform lookup: table, compile time hashed name", iterations, [&]() {
+		static constexpr UniformName name("u_ModelViewProjection");
+		doNotOptimize(table.find(name));
+	});
+
+	UniformHandle handle = table.find("u_ModelViewProjection");
+	runBenchmark("uniform lookup: precomputed handle", iterations, [&]() {
+		doNotOptimize(table.getLocation(handle));
+	});
+
+	const float color[] = {0.8f, 0.3f, 0.8f, 1.0f};
+	runBenchmark("uniform shadow: writing an unchanged vec4", iterations, [&]() {
+		doNotOptimize(table.write(handle, color, sizeof(color)));
+	});
+
+	float changing[] = {0.0f, 0.3f, 0.8f, 1.0f};
+	runBenchmark("uniform shadow: writing a changed vec4", iterations, [&]() {
+		changing[0] += 1.0f;
+		doNotOptimize(table.write(handle, changing, sizeof(changing)));
+		table.clearDirty();
+	});
+}
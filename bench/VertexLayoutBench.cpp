@@ -0,0 +1,73 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "Benchmark.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+
+namespace
+{
+	/* Without a context the GLEW function pointers are null. These take their place so that addBuffer()
+	 * runs its loop and nothing else: what we time is our side of it, the glCall checks included.
+	 * glGetError is the one call that still goes to libGL, which does nothing without a context */
+	void GLAPIENTRY stubGenObjects(GLsizei n, GLuint* ids) { for(GLsizei i = 0; i < n; i++) ids[i] = static_cast<GLuint>(i + 1); }
+	void GLAPIENTRY stubDeleteObjects(GLsizei, const GLuint*) {}
+	void GLAPIENTRY stubBindVertexArray(GLuint) {}
+	void GLAPIENTRY stubBindBuffer(GLenum, GLuint) {}
+	void GLAPIENTRY stubBufferData(GLenum, GLsizeiptr, const void*, GLenum) {}
+	void GLAPIENTRY stubVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) {}
+	void GLAPIENTRY stubEnableVertexAttribArray(GLuint) {}
+
+	void stubVertexArrayFunctions()
+	{
+		glewExperimental = GL_TRUE;
+		__glewGenVertexArrays = stubGenObjects;
+		__glewDeleteVertexArrays = stubDeleteObjects;
+		__glewBindVertexArray = stubBindVertexArray;
+		__glewGenBuffers = stubGenObjects;
+		__glewDeleteBuffers = stubDeleteObjects;
+		__glewBindBuffer = stubBindBuffer;
+		__glewBufferData = stubBufferData;
+		__glewVertexAttribPointer = stubVertexAttribPointer;
+		__glewEnableVertexAttribArray = stubEnableVertexAttribArray;
+	}
+}
+
+void runVertexLayoutBenchmarks()
+{
+	constexpr uint64_t iterations = 1000000;
+
+	// position, texture coordinates and an 8 bit color, what a sprite vertex has
+	runBenchmark("vertex layout: push float2, float2, ubyte4 and get the stride", iterations, [&]() {
+		VertexBufferLayout layout;
+		layout.push<float>(2);
+		layout.push<float>(2);
+		layout.push<unsigned char>(4);
+		doNotOptimize(layout.getStride());
+	});
+
+	VertexBufferLayout wide;
+	for(int i = 0; i < 8; i++)
+		wide.push<float>(4);
+	runBenchmark("vertex layout: stride and elements of an 8 attribute layout", iterations * 10, [&]() {
+		doNotOptimize(wide.getStride());
+		doNotOptimize(wide.getElements().size());
+	});
+
+	stubVertexArrayFunctions();
+	VertexBuffer buffer(nullptr, 0);
+	VertexArray vertexArray;
+	VertexBufferLayout sprite;
+	sprite.push<float>(2);
+	sprite.push<float>(2);
+	sprite.push<unsigned char>(4);
+
+	runBenchmark("vertex array: addBuffer, 3 attributes (stubbed gl)", iterations, [&]() {
+		vertexArray.addBuffer(buffer, sprite);
+	});
+	runBenchmark("vertex array: addBuffer, 8 attributes (stubbed gl)", iterations, [&]() {
+		vertexArray.addBuffer(buffer, wide);
+	});
+}
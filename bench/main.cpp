@@ -0,0 +1,56 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+/* CPU side benchmarks. None of these need an OpenGL context
+ *
+ *     bench [--filter <text>] [--json <file>] [--baseline <file>] [--threshold <percent>]
+ *
+ * --filter runs only the benchmarks whose name contains the text, --json writes the results for a later
+ * --baseline run to compare against. With a baseline the exit code is 1 if anything got slower than the
+ * threshold (10% unless given), so a script can tell. 2 when the baseline can't be read */
+
+#include "Benchmark.h"
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+	const char* jsonPath = nullptr;
+	const char* baselinePath = nullptr;
+	double threshold = 10.0;
+	for(int i = 1; i < argc; i++)
+	{
+		if(std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			jsonPath = argv[++i];
+		else if(std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+			baselinePath = argv[++i];
+		else if(std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+			threshold = std::atof(argv[++i]);
+		else if(std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			setBenchmarkFilter(argv[++i]);
+		else
+		{
+			std::cout << "unknown argument '" << argv[i] << "'" << std::endl;
+			return 2;
+		}
+	}
+
+	runUniformLookupBenchmarks();
+	runVertexLayoutBenchmarks();
+	runShaderParseBenchmarks();
+	runImageDecodeBenchmarks();
+	runBlockCompressionBenchmarks();
+
+	if(jsonPath && !writeBenchmarkJson(jsonPath))
+		return 2;
+	if(baselinePath)
+	{
+		const int regressions = compareWithBaseline(baselinePath, threshold);
+		if(regressions < 0)
+			return 2;
+		if(regressions > 0)
+			return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,293 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "AllocationTracker.h"
+#include <iostream>
+
+#ifdef ALLOCATION_TRACKER_ENABLED
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <execinfo.h>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	constexpr int MaxStackDepth = 24;
+
+	struct Stack
+	{
+		std::array<void*, MaxStackDepth> frames;
+		int depth;
+
+		bool operator==(const Stack& other) const
+		{
+			return depth == other.depth && std::equal(frames.begin(), frames.begin() + depth, other.frames.begin());
+		}
+	};
+
+	struct StackHash
+	{
+		size_t operator()(const Stack& stack) const
+		{
+			size_t hash = 14695981039346656037ull;
+			for(int i = 0; i < stack.depth; i++)
+				hash = (hash ^ reinterpret_cast<size_t>(stack.frames[i])) * 1099511628211ull;
+			return hash;
+		}
+	};
+
+	struct StackCount
+	{
+		uint64_t allocations;
+		uint64_t bytes;
+	};
+
+	/* Plain thread locals, zero initialised without a constructor, so they work for the allocations made
+	 * before main() too */
+	thread_local AllocationCounts threadCounts;
+	thread_local AllocationCounts frameStart;
+	thread_local bool inFrame;
+	// set while the tracker itself runs, what it allocates isn't counted and doesn't come back in here
+	thread_local bool busy;
+
+	/* Only the thread in the frame touches these, the other threads never get past inFrame */
+	bool captureStacks = false;
+	bool assertNoAllocations = false;
+	AllocationCounts lastFrame = {};
+	AllocationCounts frameTotal = {};
+	uint64_t frameCount = 0, allocatingFrames = 0, maxFrameAllocations = 0;
+
+	std::unordered_map<Stack, StackCount, StackHash>& getStacks()
+	{
+		static std::unordered_map<Stack, StackCount, StackHash> stacks;
+		return stacks;
+	}
+
+	/* "binary(_ZN6Shader4bindEv+0x1c) [0x...]" to "Shader::bind() +0x1c", what backtrace_symbols() gives
+	 * with the name demangled */
+	std::string describeFrame(const char* symbol)
+	{
+		const char* open = std::strchr(symbol, '(');
+		const char* plus = open ? std::strchr(open, '+') : nullptr;
+		if(!open || !plus || plus == open + 1)
+			return symbol;
+
+		const std::string mangled(open + 1, plus);
+		int status = 0;
+		char* demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+		std::string name = status == 0 && demangled ? demangled : mangled;
+		std::free(demangled);
+		const char* close = std::strchr(plus, ')');
+		return name + " " + (close ? std::string(plus, close) : std::string(plus));
+	}
+
+	void onAllocation(size_t size)
+	{
+		if(busy)
+			return;
+		threadCounts.allocations++;
+		threadCounts.bytes += size;
+		if(!inFrame || (!captureStacks && !assertNoAllocations))
+			return;
+
+		busy = true;
+		Stack stack;
+		// the first two are us and operator new
+		void* frames[MaxStackDepth + 2];
+		const int depth = backtrace(frames, MaxStackDepth + 2);
+		stack.depth = std::max(0, depth - 2);
+		std::copy(frames + 2, frames + 2 + stack.depth, stack.frames.begin());
+
+		if(assertNoAllocations)
+		{
+			// nothing that allocates from here on, we might be out of memory or in the middle of the allocator
+			std::fprintf(stderr, "AllocationTracker: allocation of %zu bytes in a frame that mustn't allocate\n", size);
+			backtrace_symbols_fd(stack.frames.data(), stack.depth, 2);
+			__builtin_trap();
+		}
+
+		StackCount& count = getStacks()[stack];
+		count.allocations++;
+		count.bytes += size;
+		busy = false;
+	}
+
+	void* allocate(size_t size, size_t alignment)
+	{
+		if(size == 0)
+			size = 1;
+		void* pointer = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+				? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+				: std::malloc(size);
+		if(pointer)
+			onAllocation(size);
+		return pointer;
+	}
+}
+
+void* operator new(size_t size)
+{
+	if(void* pointer = allocate(size, 0))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if(void* pointer = allocate(size, static_cast<size_t>(alignment)))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size, 0);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocate(size, static_cast<size_t>(alignment));
+}
+
+/* malloc and aligned_alloc memory both go back with free() */
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { std::free(pointer); }
+
+AllocationCounts AllocationTracker::getThreadCounts()
+{
+	return threadCounts;
+}
+
+void AllocationTracker::beginFrame()
+{
+	frameStart = threadCounts;
+	inFrame = true;
+}
+
+AllocationCounts AllocationTracker::endFrame()
+{
+	inFrame = false;
+	lastFrame = {threadCounts.allocations - frameStart.allocations, threadCounts.bytes - frameStart.bytes};
+	frameTotal.allocations += lastFrame.allocations;
+	frameTotal.bytes += lastFrame.bytes;
+	frameCount++;
+	allocatingFrames += lastFrame.allocations > 0;
+	maxFrameAllocations = std::max(maxFrameAllocations, lastFrame.allocations);
+	return lastFrame;
+}
+
+AllocationCounts AllocationTracker::getLastFrame()
+{
+	return lastFrame;
+}
+
+void AllocationTracker::setCaptureStacks(bool capture)
+{
+	if(capture)
+	{
+		// the first backtrace() loads the unwinder, better not in the middle of a frame
+		void* frame;
+		backtrace(&frame, 1);
+	}
+	captureStacks = capture;
+}
+
+void AllocationTracker::setAssertNoAllocations(bool enabled)
+{
+	assertNoAllocations = enabled;
+}
+
+void AllocationTracker::printReport(size_t maxStacks)
+{
+	busy = true;
+	std::cout << "Allocations in " << frameCount << " frames: " << frameTotal.allocations << " (" << frameTotal.bytes
+			  << " bytes), " << allocatingFrames << " frames allocated, at most " << maxFrameAllocations << " in a frame" << std::endl;
+
+	std::vector<std::pair<Stack, StackCount>> stacks(getStacks().begin(), getStacks().end());
+	std::sort(stacks.begin(), stacks.end(), [](const auto& a, const auto& b) { return a.second.allocations > b.second.allocations; });
+	if(stacks.size() > maxStacks)
+		stacks.resize(maxStacks);
+	for(const auto& [stack, count] : stacks)
+	{
+		std::cout << "  " << count.allocations << " allocations, " << count.bytes << " bytes, from" << std::endl;
+		char** symbols = backtrace_symbols(stack.frames.data(), stack.depth);
+		for(int i = 0; symbols && i < stack.depth; i++)
+			std::cout << "    " << describeFrame(symbols[i]) << std::endl;
+		std::free(symbols);
+	}
+	busy = false;
+}
+
+#else
+
+AllocationCounts AllocationTracker::getThreadCounts()
+{
+	return {};
+}
+
+void AllocationTracker::beginFrame()
+{
+}
+
+AllocationCounts AllocationTracker::endFrame()
+{
+	return {};
+}
+
+AllocationCounts AllocationTracker::getLastFrame()
+{
+	return {};
+}
+
+void AllocationTracker::setCaptureStacks(bool)
+{
+}
+
+void AllocationTracker::setAssertNoAllocations(bool)
+{
+}
+
+void AllocationTracker::printReport(size_t)
+{
+	std::cout << "AllocationTracker: nothing was counted, configure with -DENABLE_ALLOCATION_TRACKER=ON" << std::endl;
+}
+
+#endif
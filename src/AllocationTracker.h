@@ -0,0 +1,67 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_ALLOCATIONTRACKER_H
+#define OPENGL_THECHERNO_ALLOCATIONTRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct AllocationCounts
+{
+	uint64_t allocations; // calls to operator new
+	uint64_t bytes; // what they asked for
+};
+
+/* Finds the heap allocations of the frame loop. Built with -DENABLE_ALLOCATION_TRACKER=ON (which defines
+ * ALLOCATION_TRACKER_ENABLED) it replaces the global operator new and delete, and every thread counts what
+ * it allocates. Counting is two increments of thread local variables, allocating goes to malloc as before.
+ *
+ *     while(...)
+ *     {
+ *         AllocationTracker::beginFrame();
+ *         ...
+ *         AllocationTracker::endFrame();
+ *     }
+ *
+ * Between the two the calling thread is in the frame, and only that thread: the texture loader's workers
+ * allocate as they like. Inside the frame the tracker can remember where each allocation came from
+ * (setCaptureStacks()) or stop the program at the first one (setAssertNoAllocations()), for a loop that
+ * should no longer allocate once it's warmed up. With the profiler on, every PROFILE_SCOPE shows the
+ * allocations made in it in the trace.
+ *
+ * Without the option none of it is built in: the counts stay 0 and the settings do nothing */
+class AllocationTracker
+{
+public:
+	static constexpr bool isEnabled()
+	{
+#ifdef ALLOCATION_TRACKER_ENABLED
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/* everything the calling thread allocated since it started */
+	static AllocationCounts getThreadCounts();
+
+	static void beginFrame();
+	/* what the frame allocated, also kept for getLastFrame() and the report */
+	static AllocationCounts endFrame();
+	static AllocationCounts getLastFrame();
+
+	/* Keeps the call stack of every allocation in a frame, counted per distinct stack. It costs a stack walk
+	 * per allocation, and for names in the stacks the program has to be linked with -rdynamic (the cmake
+	 * option does that) */
+	static void setCaptureStacks(bool capture);
+	/* Any allocation in a frame prints its stack and traps, like ASSERT does */
+	static void setAssertNoAllocations(bool enabled);
+
+	/* allocations per frame and the most frequent stacks, if they were captured */
+	static void printReport(size_t maxStacks = 10);
+};
+
+
+#endif //OPENGL_THECHERNO_ALLOCATIONTRACKER_H
@@ -0,0 +1,822 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "BlockCompression.h"
+#include "Image.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#include <immintrin.h>
+#define BLOCK_COMPRESSION_X86
+#endif
+
+namespace
+{
+	inline uint16_t packRGB565(const float* color)
+	{
+		auto quantize = [](float value, int maximum) {
+			return static_cast<uint16_t>(std::clamp(static_cast<int>(value * maximum / 255.0f + 0.5f), 0, maximum));
+		};
+		return static_cast<uint16_t>(quantize(color[0], 31) << 11 | quantize(color[1], 63) << 5 | quantize(color[2], 31));
+	}
+
+	inline void unpackRGB565(uint16_t packed, int* color)
+	{
+		// repeat the top bits in the bottom ones, so 31 becomes 255 and not 248
+		int r = packed >> 11 & 31, g = packed >> 5 & 63, b = packed & 31;
+		color[0] = r << 3 | r >> 2;
+		color[1] = g << 2 | g >> 4;
+		color[2] = b << 3 | b >> 2;
+	}
+
+	void writeBC1(uint16_t color0, uint16_t color1, uint32_t indices, unsigned char* block)
+	{
+		block[0] = color0 & 0xFF;
+		block[1] = color0 >> 8;
+		block[2] = color1 & 0xFF;
+		block[3] = color1 >> 8;
+		std::memcpy(block + 4, &indices, 4);
+	}
+
+	void writeBC4(int high, int low, uint64_t indices, unsigned char* block)
+	{
+		block[0] = static_cast<unsigned char>(high);
+		block[1] = static_cast<unsigned char>(low);
+		// 16 indices of 3 bits, 48 bits after the two values
+		for(int byte = 0; byte < 6; byte++)
+			block[2 + byte] = static_cast<unsigned char>(indices >> (byte * 8));
+	}
+
+	/* The principal axis of the colors by power iteration, cov holds the 6 unique entries of the
+	 * covariance. A handful of steps is plenty for 16 pixels. The axis is not normalized */
+	void principalAxis(const float* cov, float* axis)
+	{
+		axis[0] = axis[1] = axis[2] = 1.0f;
+		for(int step = 0; step < 6; step++)
+		{
+			float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+			float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+			float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+			float length = std::max({std::fabs(x), std::fabs(y), std::fabs(z)});
+			if(length < 1e-6f)
+				break; // every pixel is the same color, any axis will do
+			axis[0] = x / length; axis[1] = y / length; axis[2] = z / length;
+		}
+	}
+
+	/* The two 565 endpoints at mean + axis * t for the smallest and largest t, color0 > color1.
+	 * Returns false when both round to the same color */
+	bool fitEndpoints(const float* mean, const float* axis, float minT, float maxT, uint16_t& color0, uint16_t& color1)
+	{
+		float high[3], low[3];
+		for(int c = 0; c < 3; c++)
+		{
+			high[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+			low[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+		}
+
+		color0 = packRGB565(high);
+		color1 = packRGB565(low);
+		/* color0 > color1 selects the 4 color mode. With color0 <= color1 the decoder would use 3 colors
+		 * and make index 3 transparent black, so we swap when we have to */
+		if(color0 < color1)
+			std::swap(color0, color1);
+		return color0 != color1;
+	}
+
+	/* BC1 index for k thirds of the way from color1 to color0: index 0 is color0, 1 is color1,
+	 * 2 is two thirds of the way to color0 and 3 one third */
+	constexpr uint32_t BC1IndexForStep[4] = {1, 3, 2, 0};
+	/* BC4 index for k sevenths of the way from high to low: index 0 is high, 1 is low, 2 to 7 are in between */
+	constexpr uint64_t BC4IndexForStep[8] = {0, 2, 3, 4, 5, 6, 7, 1};
+}
+
+void encodeBC1Block(const unsigned char* rgba, unsigned char* block)
+{
+	float mean[3] = {0.0f, 0.0f, 0.0f};
+	for(int i = 0; i < 16; i++)
+		for(int c = 0; c < 3; c++)
+			mean[c] += rgba[i * 4 + c];
+	for(float& m : mean)
+		m /= 16.0f;
+
+	// covariance of the colors, only the 6 unique entries
+	float cov[6] = {};
+	for(int i = 0; i < 16; i++)
+	{
+		float r = rgba[i * 4] - mean[0], g = rgba[i * 4 + 1] - mean[1], b = rgba[i * 4 + 2] - mean[2];
+		cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+		cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+	}
+
+	float axis[3];
+	principalAxis(cov, axis);
+	float axisLength = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+	float minT = 0.0f, maxT = 0.0f;
+	for(int i = 0; i < 16; i++)
+	{
+		float t = ((rgba[i * 4] - mean[0]) * axis[0] + (rgba[i * 4 + 1] - mean[1]) * axis[1]
+				+ (rgba[i * 4 + 2] - mean[2]) * axis[2]) / axisLength;
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+
+	uint16_t color0, color1;
+	if(!fitEndpoints(mean, axis, minT, maxT, color0, color1))
+	{
+		writeBC1(color0, color1, 0, block);
+		return;
+	}
+
+	int palette[4][3];
+	unpackRGB565(color0, palette[0]);
+	unpackRGB565(color1, palette[1]);
+	for(int c = 0; c < 3; c++)
+	{
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+
+	uint32_t indices = 0;
+	for(int i = 0; i < 16; i++)
+	{
+		int best = 0, bestDistance = 1 << 30;
+		for(int p = 0; p < 4; p++)
+		{
+			int dr = rgba[i * 4] - palette[p][0], dg = rgba[i * 4 + 1] - palette[p][1], db = rgba[i * 4 + 2] - palette[p][2];
+			int distance = dr * dr + dg * dg + db * db;
+			if(distance < bestDistance)
+			{
+				bestDistance = distance;
+				best = p;
+			}
+		}
+		indices |= static_cast<uint32_t>(best) << (i * 2);
+	}
+	writeBC1(color0, color1, indices, block);
+}
+
+void encodeBC4Block(const unsigned char* rgba, int channel, unsigned char* block)
+{
+	int low = 255, high = 0;
+	for(int i = 0; i < 16; i++)
+	{
+		low = std::min<int>(low, rgba[i * 4 + channel]);
+		high = std::max<int>(high, rgba[i * 4 + channel]);
+	}
+
+	uint64_t indices = 0;
+	if(high != low)
+	{
+		/* high > low selects 8 steps: index 0 is high, 1 is low, 2 to 7 are in between from high to low */
+		int palette[8] = {high, low};
+		for(int k = 1; k <= 6; k++)
+			palette[k + 1] = ((7 - k) * high + k * low) / 7;
+
+		for(int i = 0; i < 16; i++)
+		{
+			int value = rgba[i * 4 + channel];
+			int best = 0;
+			for(int p = 1; p < 8; p++)
+			{
+				if(std::abs(palette[p] - value) < std::abs(palette[best] - value))
+					best = p;
+			}
+			indices |= static_cast<uint64_t>(best) << (i * 3);
+		}
+	}
+	writeBC4(high, low, indices, block);
+}
+
+void encodeBC3Block(const unsigned char* rgba, unsigned char* block)
+{
+	encodeBC4Block(rgba, 3, block);
+	encodeBC1Block(rgba, block + 8);
+}
+
+void encodeBC5Block(const unsigned char* rgba, unsigned char* block)
+{
+	encodeBC4Block(rgba, 0, block);
+	encodeBC4Block(rgba, 1, block + 8);
+}
+
+#ifdef BLOCK_COMPRESSION_X86
+/* The vector encoders do the same range fit, but pick the indices by projecting each pixel onto the
+ * line between the two decoded endpoints and rounding to the nearest step, instead of trying every
+ * palette entry. That is the same answer for pixels on the line and very close for the rest, and it
+ * has no branches, so it runs on 4 pixels (SSE2) or 8 blocks (AVX2) at once.
+ * SSE2 is part of every x86-64 cpu. AVX2 is compiled in with a target attribute and only called
+ * after getBestBlockEncoder() found it at runtime */
+namespace
+{
+	inline float horizontalSum(__m128 v)
+	{
+		__m128 sum = _mm_add_ps(v, _mm_movehl_ps(v, v));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+		return _mm_cvtss_f32(sum);
+	}
+
+	inline float horizontalMin(__m128 v)
+	{
+		__m128 m = _mm_min_ps(v, _mm_movehl_ps(v, v));
+		m = _mm_min_ss(m, _mm_shuffle_ps(m, m, 1));
+		return _mm_cvtss_f32(m);
+	}
+
+	inline float horizontalMax(__m128 v)
+	{
+		__m128 m = _mm_max_ps(v, _mm_movehl_ps(v, v));
+		m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+		return _mm_cvtss_f32(m);
+	}
+
+	/* one channel of 4 pixels as floats */
+	inline __m128 channelSSE2(__m128i pixels, int channel)
+	{
+		__m128i shifted = _mm_srl_epi32(pixels, _mm_cvtsi32_si128(channel * 8));
+		return _mm_cvtepi32_ps(_mm_and_si128(shifted, _mm_set1_epi32(0xFF)));
+	}
+
+	void encodeBC4BlockSSE2(const unsigned char* rgba, int channel, unsigned char* block)
+	{
+		__m128 values[4];
+		for(int i = 0; i < 4; i++)
+			values[i] = channelSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + i * 16)), channel);
+
+		__m128 lows = _mm_min_ps(_mm_min_ps(values[0], values[1]), _mm_min_ps(values[2], values[3]));
+		__m128 highs = _mm_max_ps(_mm_max_ps(values[0], values[1]), _mm_max_ps(values[2], values[3]));
+		int low = static_cast<int>(horizontalMin(lows)), high = static_cast<int>(horizontalMax(highs));
+
+		uint64_t indices = 0;
+		if(high != low)
+		{
+			// sevenths of the way from high down to low, rounded to the nearest
+			__m128 highVector = _mm_set1_ps(static_cast<float>(high));
+			__m128 scale = _mm_set1_ps(7.0f / static_cast<float>(high - low));
+			alignas(16) int32_t steps[16];
+			for(int i = 0; i < 4; i++)
+			{
+				__m128 step = _mm_mul_ps(_mm_sub_ps(highVector, values[i]), scale);
+				_mm_store_si128(reinterpret_cast<__m128i*>(steps + i * 4), _mm_cvtps_epi32(step));
+			}
+			for(int i = 0; i < 16; i++)
+				indices |= BC4IndexForStep[steps[i]] << (i * 3);
+		}
+		writeBC4(high, low, indices, block);
+	}
+
+	void encodeBC1BlockSSE2(const unsigned char* rgba, unsigned char* block)
+	{
+		__m128 r[4], g[4], b[4];
+		for(int i = 0; i < 4; i++)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + i * 16));
+			r[i] = channelSSE2(pixels, 0);
+			g[i] = channelSSE2(pixels, 1);
+			b[i] = channelSSE2(pixels, 2);
+		}
+
+		float mean[3] = {
+			horizontalSum(_mm_add_ps(_mm_add_ps(r[0], r[1]), _mm_add_ps(r[2], r[3]))) / 16.0f,
+			horizontalSum(_mm_add_ps(_mm_add_ps(g[0], g[1]), _mm_add_ps(g[2], g[3]))) / 16.0f,
+			horizontalSum(_mm_add_ps(_mm_add_ps(b[0], b[1]), _mm_add_ps(b[2], b[3]))) / 16.0f,
+		};
+		__m128 meanR = _mm_set1_ps(mean[0]), meanG = _mm_set1_ps(mean[1]), meanB = _mm_set1_ps(mean[2]);
+
+		__m128 covariance[6] = {};
+		__m128 dr[4], dg[4], db[4];
+		for(int i = 0; i < 4; i++)
+		{
+			dr[i] = _mm_sub_ps(r[i], meanR);
+			dg[i] = _mm_sub_ps(g[i], meanG);
+			db[i] = _mm_sub_ps(b[i], meanB);
+			covariance[0] = _mm_add_ps(covariance[0], _mm_mul_ps(dr[i], dr[i]));
+			covariance[1] = _mm_add_ps(covariance[1], _mm_mul_ps(dr[i], dg[i]));
+			covariance[2] = _mm_add_ps(covariance[2], _mm_mul_ps(dr[i], db[i]));
+			covariance[3] = _mm_add_ps(covariance[3], _mm_mul_ps(dg[i], dg[i]));
+			covariance[4] = _mm_add_ps(covariance[4], _mm_mul_ps(dg[i], db[i]));
+			covariance[5] = _mm_add_ps(covariance[5], _mm_mul_ps(db[i], db[i]));
+		}
+		float cov[6];
+		for(int i = 0; i < 6; i++)
+			cov[i] = horizontalSum(covariance[i]);
+
+		float axis[3];
+		principalAxis(cov, axis);
+		float axisLength = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+		__m128 axisR = _mm_set1_ps(axis[0]), axisG = _mm_set1_ps(axis[1]), axisB = _mm_set1_ps(axis[2]);
+		__m128 minT = _mm_setzero_ps(), maxT = _mm_setzero_ps();
+		for(int i = 0; i < 4; i++)
+		{
+			__m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr[i], axisR), _mm_mul_ps(dg[i], axisG)), _mm_mul_ps(db[i], axisB));
+			minT = _mm_min_ps(minT, t);
+			maxT = _mm_max_ps(maxT, t);
+		}
+
+		uint16_t color0, color1;
+		if(!fitEndpoints(mean, axis, horizontalMin(minT) / axisLength, horizontalMax(maxT) / axisLength, color0, color1))
+		{
+			writeBC1(color0, color1, 0, block);
+			return;
+		}
+
+		int end0[3], end1[3];
+		unpackRGB565(color0, end0);
+		unpackRGB565(color1, end1);
+		float lineR = static_cast<float>(end0[0] - end1[0]);
+		float lineG = static_cast<float>(end0[1] - end1[1]);
+		float lineB = static_cast<float>(end0[2] - end1[2]);
+		// thirds of the way from color1 to color0
+		float stepScale = 3.0f / (lineR * lineR + lineG * lineG + lineB * lineB);
+
+		__m128 startR = _mm_set1_ps(static_cast<float>(end1[0]));
+		__m128 startG = _mm_set1_ps(static_cast<float>(end1[1]));
+		__m128 startB = _mm_set1_ps(static_cast<float>(end1[2]));
+		__m128 stepR = _mm_set1_ps(lineR * stepScale), stepG = _mm_set1_ps(lineG * stepScale), stepB = _mm_set1_ps(lineB * stepScale);
+		__m128 zero = _mm_setzero_ps(), three = _mm_set1_ps(3.0f);
+		alignas(16) int32_t steps[16];
+		for(int i = 0; i < 4; i++)
+		{
+			__m128 step = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(_mm_sub_ps(r[i], startR), stepR),
+					_mm_mul_ps(_mm_sub_ps(g[i], startG), stepG)),
+					_mm_mul_ps(_mm_sub_ps(b[i], startB), stepB));
+			step = _mm_min_ps(_mm_max_ps(step, zero), three);
+			_mm_store_si128(reinterpret_cast<__m128i*>(steps + i * 4), _mm_cvtps_epi32(step));
+		}
+
+		uint32_t indices = 0;
+		for(int i = 0; i < 16; i++)
+			indices |= BC1IndexForStep[steps[i]] << (i * 2);
+		writeBC1(color0, color1, indices, block);
+	}
+
+	void encodeBC3BlockSSE2(const unsigned char* rgba, unsigned char* block)
+	{
+		encodeBC4BlockSSE2(rgba, 3, block);
+		encodeBC1BlockSSE2(rgba, block + 8);
+	}
+
+	void encodeBC5BlockSSE2(const unsigned char* rgba, unsigned char* block)
+	{
+		encodeBC4BlockSSE2(rgba, 0, block);
+		encodeBC4BlockSSE2(rgba, 1, block + 8);
+	}
+
+	/* The AVX2 encoders work on 8 whole blocks side by side, one block per lane, so the whole fit runs
+	 * in vectors, the power iteration and the 565 rounding included. Doing one block at a time with 8
+	 * pixels per vector is no faster than SSE2, the per block scalar work is what takes the time.
+	 * rgba points at the top left pixel of the first block, rows are stride bytes apart and block b
+	 * is written to out + b * blockSize */
+	constexpr int BlocksPerBatch = 8;
+
+	__attribute__((target("avx2"))) inline void gatherBlocksAVX2(const unsigned char* rgba, size_t stride, __m256i* pixels)
+	{
+		// the same pixel of each of the 8 blocks, which are 16 bytes apart
+		const __m256i offsets = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+		for(int y = 0; y < 4; y++)
+			for(int x = 0; x < 4; x++)
+				pixels[y * 4 + x] = _mm256_i32gather_epi32(reinterpret_cast<const int*>(rgba + y * stride + x * 4), offsets, 4);
+	}
+
+	__attribute__((target("avx2"))) inline __m256 channelAVX2(__m256i pixels, int channel)
+	{
+		__m256i shifted = _mm256_srl_epi32(pixels, _mm_cvtsi32_si128(channel * 8));
+		return _mm256_cvtepi32_ps(_mm256_and_si256(shifted, _mm256_set1_epi32(0xFF)));
+	}
+
+	__attribute__((target("avx2"))) inline __m256i quantizeAVX2(__m256 value, float maximum)
+	{
+		value = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+		return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(maximum / 255.0f)), _mm256_set1_ps(0.5f)));
+	}
+
+	/* the same rounding as packRGB565() */
+	__attribute__((target("avx2"))) inline __m256i packRGB565AVX2(__m256 r, __m256 g, __m256 b)
+	{
+		return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(quantizeAVX2(r, 31.0f), 11),
+				_mm256_slli_epi32(quantizeAVX2(g, 63.0f), 5)), quantizeAVX2(b, 31.0f));
+	}
+
+	__attribute__((target("avx2"))) inline __m256 expandAVX2(__m256i packed, int shift, int bits)
+	{
+		// the same bit repetition as unpackRGB565()
+		__m256i value = _mm256_and_si256(_mm256_srl_epi32(packed, _mm_cvtsi32_si128(shift)), _mm256_set1_epi32((1 << bits) - 1));
+		__m256i expanded = _mm256_or_si256(_mm256_sll_epi32(value, _mm_cvtsi32_si128(8 - bits)), _mm256_srl_epi32(value, _mm_cvtsi32_si128(2 * bits - 8)));
+		return _mm256_cvtepi32_ps(expanded);
+	}
+
+	__attribute__((target("avx2"))) void encodeBC1BlocksAVX2(const unsigned char* rgba, size_t stride, unsigned char* out, unsigned int blockSize)
+	{
+		__m256i pixels[16];
+		gatherBlocksAVX2(rgba, stride, pixels);
+
+		__m256 r[16], g[16], b[16];
+		__m256 meanR = _mm256_setzero_ps(), meanG = _mm256_setzero_ps(), meanB = _mm256_setzero_ps();
+		for(int i = 0; i < 16; i++)
+		{
+			r[i] = channelAVX2(pixels[i], 0);
+			g[i] = channelAVX2(pixels[i], 1);
+			b[i] = channelAVX2(pixels[i], 2);
+			meanR = _mm256_add_ps(meanR, r[i]);
+			meanG = _mm256_add_ps(meanG, g[i]);
+			meanB = _mm256_add_ps(meanB, b[i]);
+		}
+		const __m256 sixteenth = _mm256_set1_ps(1.0f / 16.0f);
+		meanR = _mm256_mul_ps(meanR, sixteenth);
+		meanG = _mm256_mul_ps(meanG, sixteenth);
+		meanB = _mm256_mul_ps(meanB, sixteenth);
+
+		__m256 cov[6];
+		for(__m256& c : cov)
+			c = _mm256_setzero_ps();
+		for(int i = 0; i < 16; i++)
+		{
+			__m256 dr = _mm256_sub_ps(r[i], meanR), dg = _mm256_sub_ps(g[i], meanG), db = _mm256_sub_ps(b[i], meanB);
+			cov[0] = _mm256_add_ps(cov[0], _mm256_mul_ps(dr, dr));
+			cov[1] = _mm256_add_ps(cov[1], _mm256_mul_ps(dr, dg));
+			cov[2] = _mm256_add_ps(cov[2], _mm256_mul_ps(dr, db));
+			cov[3] = _mm256_add_ps(cov[3], _mm256_mul_ps(dg, dg));
+			cov[4] = _mm256_add_ps(cov[4], _mm256_mul_ps(dg, db));
+			cov[5] = _mm256_add_ps(cov[5], _mm256_mul_ps(db, db));
+		}
+
+		// principalAxis() for 8 blocks, lanes whose colors are all the same keep the axis they have
+		const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+		__m256 axisR = _mm256_set1_ps(1.0f), axisG = axisR, axisB = axisR;
+		for(int step = 0; step < 6; step++)
+		{
+			__m256 x = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cov[0], axisR), _mm256_mul_ps(cov[1], axisG)), _mm256_mul_ps(cov[2], axisB));
+			__m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cov[1], axisR), _mm256_mul_ps(cov[3], axisG)), _mm256_mul_ps(cov[4], axisB));
+			__m256 z = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cov[2], axisR), _mm256_mul_ps(cov[4], axisG)), _mm256_mul_ps(cov[5], axisB));
+			__m256 length = _mm256_max_ps(_mm256_and_ps(x, absMask), _mm256_max_ps(_mm256_and_ps(y, absMask), _mm256_and_ps(z, absMask)));
+			__m256 keep = _mm256_cmp_ps(length, _mm256_set1_ps(1e-6f), _CMP_LT_OQ);
+			__m256 inverse = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_max_ps(length, _mm256_set1_ps(1e-6f)));
+			axisR = _mm256_blendv_ps(_mm256_mul_ps(x, inverse), axisR, keep);
+			axisG = _mm256_blendv_ps(_mm256_mul_ps(y, inverse), axisG, keep);
+			axisB = _mm256_blendv_ps(_mm256_mul_ps(z, inverse), axisB, keep);
+		}
+
+		__m256 minT = _mm256_setzero_ps(), maxT = _mm256_setzero_ps();
+		for(int i = 0; i < 16; i++)
+		{
+			__m256 t = _mm256_add_ps(_mm256_add_ps(
+					_mm256_mul_ps(_mm256_sub_ps(r[i], meanR), axisR),
+					_mm256_mul_ps(_mm256_sub_ps(g[i], meanG), axisG)),
+					_mm256_mul_ps(_mm256_sub_ps(b[i], meanB), axisB));
+			minT = _mm256_min_ps(minT, t);
+			maxT = _mm256_max_ps(maxT, t);
+		}
+		__m256 inverseLength = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(axisR, axisR), _mm256_mul_ps(axisG, axisG)), _mm256_mul_ps(axisB, axisB)));
+		minT = _mm256_mul_ps(minT, inverseLength);
+		maxT = _mm256_mul_ps(maxT, inverseLength);
+
+		// fitEndpoints()
+		__m256i high = packRGB565AVX2(_mm256_add_ps(meanR, _mm256_mul_ps(axisR, maxT)),
+				_mm256_add_ps(meanG, _mm256_mul_ps(axisG, maxT)), _mm256_add_ps(meanB, _mm256_mul_ps(axisB, maxT)));
+		__m256i low = packRGB565AVX2(_mm256_add_ps(meanR, _mm256_mul_ps(axisR, minT)),
+				_mm256_add_ps(meanG, _mm256_mul_ps(axisG, minT)), _mm256_add_ps(meanB, _mm256_mul_ps(axisB, minT)));
+		__m256i color0 = _mm256_max_epi32(high, low), color1 = _mm256_min_epi32(high, low);
+		__m256i same = _mm256_cmpeq_epi32(color0, color1);
+
+		// the indices, by projecting onto the line between the decoded endpoints
+		__m256 startR = expandAVX2(color1, 11, 5), startG = expandAVX2(color1, 5, 6), startB = expandAVX2(color1, 0, 5);
+		__m256 lineR = _mm256_sub_ps(expandAVX2(color0, 11, 5), startR);
+		__m256 lineG = _mm256_sub_ps(expandAVX2(color0, 5, 6), startG);
+		__m256 lineB = _mm256_sub_ps(expandAVX2(color0, 0, 5), startB);
+		__m256 lineLength = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(lineR, lineR), _mm256_mul_ps(lineG, lineG)), _mm256_mul_ps(lineB, lineB));
+		// thirds of the way from color1 to color0, lanes with a single color are masked out below
+		__m256 stepScale = _mm256_div_ps(_mm256_set1_ps(3.0f), _mm256_max_ps(lineLength, _mm256_set1_ps(1.0f)));
+		lineR = _mm256_mul_ps(lineR, stepScale);
+		lineG = _mm256_mul_ps(lineG, stepScale);
+		lineB = _mm256_mul_ps(lineB, stepScale);
+
+		const __m256i indexForStep = _mm256_setr_epi32(BC1IndexForStep[0], BC1IndexForStep[1], BC1IndexForStep[2], BC1IndexForStep[3], 0, 0, 0, 0);
+		const __m256 zero = _mm256_setzero_ps(), three = _mm256_set1_ps(3.0f);
+		__m256i indices = _mm256_setzero_si256();
+		for(int i = 0; i < 16; i++)
+		{
+			__m256 step = _mm256_add_ps(_mm256_add_ps(
+					_mm256_mul_ps(_mm256_sub_ps(r[i], startR), lineR),
+					_mm256_mul_ps(_mm256_sub_ps(g[i], startG), lineG)),
+					_mm256_mul_ps(_mm256_sub_ps(b[i], startB), lineB));
+			step = _mm256_min_ps(_mm256_max_ps(step, zero), three);
+			__m256i index = _mm256_permutevar8x32_epi32(indexForStep, _mm256_cvtps_epi32(step));
+			indices = _mm256_or_si256(indices, _mm256_slli_epi32(index, i * 2));
+		}
+		indices = _mm256_andnot_si256(same, indices);
+
+		alignas(32) uint32_t colors0[BlocksPerBatch], colors1[BlocksPerBatch], blockIndices[BlocksPerBatch];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(colors0), color0);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(colors1), color1);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(blockIndices), indices);
+		for(int block = 0; block < BlocksPerBatch; block++)
+			writeBC1(static_cast<uint16_t>(colors0[block]), static_cast<uint16_t>(colors1[block]), blockIndices[block], out + block * blockSize);
+	}
+
+	__attribute__((target("avx2"))) void encodeBC4BlocksAVX2(const unsigned char* rgba, size_t stride, int channel, unsigned char* out, unsigned int blockSize)
+	{
+		__m256i pixels[16];
+		gatherBlocksAVX2(rgba, stride, pixels);
+
+		__m256 values[16];
+		__m256 low = _mm256_set1_ps(255.0f), high = _mm256_setzero_ps();
+		for(int i = 0; i < 16; i++)
+		{
+			values[i] = channelAVX2(pixels[i], channel);
+			low = _mm256_min_ps(low, values[i]);
+			high = _mm256_max_ps(high, values[i]);
+		}
+
+		// sevenths of the way from high down to low, lanes where high == low get index 0 everywhere
+		__m256 scale = _mm256_div_ps(_mm256_set1_ps(7.0f), _mm256_max_ps(_mm256_sub_ps(high, low), _mm256_set1_ps(1.0f)));
+		__m256i same = _mm256_castps_si256(_mm256_cmp_ps(high, low, _CMP_EQ_OQ));
+		const __m256i indexForStep = _mm256_setr_epi32(BC4IndexForStep[0], BC4IndexForStep[1], BC4IndexForStep[2], BC4IndexForStep[3],
+				BC4IndexForStep[4], BC4IndexForStep[5], BC4IndexForStep[6], BC4IndexForStep[7]);
+		// 48 bits of indices don't fit a lane, so the first and last 8 pixels are 24 bits each
+		__m256i first = _mm256_setzero_si256(), last = _mm256_setzero_si256();
+		for(int i = 0; i < 16; i++)
+		{
+			__m256 step = _mm256_mul_ps(_mm256_sub_ps(high, values[i]), scale);
+			__m256i index = _mm256_permutevar8x32_epi32(indexForStep, _mm256_cvtps_epi32(step));
+			if(i < 8)
+				first = _mm256_or_si256(first, _mm256_slli_epi32(index, i * 3));
+			else
+				last = _mm256_or_si256(last, _mm256_slli_epi32(index, (i - 8) * 3));
+		}
+		first = _mm256_andnot_si256(same, first);
+		last = _mm256_andnot_si256(same, last);
+
+		alignas(32) int32_t highs[BlocksPerBatch], lows[BlocksPerBatch];
+		alignas(32) uint32_t firstIndices[BlocksPerBatch], lastIndices[BlocksPerBatch];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(highs), _mm256_cvtps_epi32(high));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lows), _mm256_cvtps_epi32(low));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(firstIndices), first);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lastIndices), last);
+		for(int block = 0; block < BlocksPerBatch; block++)
+			writeBC4(highs[block], lows[block], firstIndices[block] | static_cast<uint64_t>(lastIndices[block]) << 24, out + block * blockSize);
+	}
+
+	/* 8 blocks of the given format from 4 rows of 32 pixels */
+	__attribute__((target("avx2"))) void encodeBlocksAVX2(const unsigned char* rgba, size_t stride, unsigned int format, unsigned char* out)
+	{
+		switch(format)
+		{
+			case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+				encodeBC1BlocksAVX2(rgba, stride, out, 8);
+				break;
+			case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+				encodeBC4BlocksAVX2(rgba, stride, 3, out, 16);
+				encodeBC1BlocksAVX2(rgba, stride, out + 8, 16);
+				break;
+			case GL_COMPRESSED_RED_RGTC1:
+				encodeBC4BlocksAVX2(rgba, stride, 0, out, 8);
+				break;
+			case GL_COMPRESSED_RG_RGTC2:
+				encodeBC4BlocksAVX2(rgba, stride, 0, out, 16);
+				encodeBC4BlocksAVX2(rgba, stride, 1, out + 8, 16);
+				break;
+		}
+	}
+}
+#endif
+
+BlockEncoder getBestBlockEncoder()
+{
+#ifdef BLOCK_COMPRESSION_X86
+	static const BlockEncoder best = __builtin_cpu_supports("avx2") ? BlockEncoder::AVX2 : BlockEncoder::SSE2;
+	return best;
+#else
+	return BlockEncoder::Scalar;
+#endif
+}
+
+bool isBlockEncoderSupported(BlockEncoder encoder)
+{
+	return static_cast<int>(encoder) <= static_cast<int>(getBestBlockEncoder());
+}
+
+const char* getBlockEncoderName(BlockEncoder encoder)
+{
+	switch(encoder)
+	{
+		case BlockEncoder::Scalar:	return "scalar";
+		case BlockEncoder::SSE2:	return "sse2";
+		case BlockEncoder::AVX2:	return "avx2";
+	}
+	return "unknown";
+}
+
+bool compressLevel(const unsigned char* rgba, int width, int height, unsigned int format, unsigned char* out, BlockEncoder encoder)
+{
+	if(!isBlockEncoderSupported(encoder))
+		encoder = getBestBlockEncoder();
+
+	void (*encode)(const unsigned char*, unsigned char*) = nullptr;
+	switch(format)
+	{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:	encode = encodeBC1Block; break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:	encode = encodeBC3Block; break;
+		case GL_COMPRESSED_RED_RGTC1:	encode = [](const unsigned char* p, unsigned char* b) { encodeBC4Block(p, 0, b); }; break;
+		case GL_COMPRESSED_RG_RGTC2:	encode = encodeBC5Block; break;
+		default: return false;
+	}
+#ifdef BLOCK_COMPRESSION_X86
+	if(encoder != BlockEncoder::Scalar)
+	{
+		switch(format)
+		{
+			case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+			case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:	encode = encodeBC1BlockSSE2; break;
+			case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:	encode = encodeBC3BlockSSE2; break;
+			case GL_COMPRESSED_RED_RGTC1:	encode = [](const unsigned char* p, unsigned char* b) { encodeBC4BlockSSE2(p, 0, b); }; break;
+			case GL_COMPRESSED_RG_RGTC2:	encode = encodeBC5BlockSSE2; break;
+		}
+	}
+#endif
+	const unsigned int blockSize = CompressedImage::getBlockSize(format);
+
+	const size_t stride = static_cast<size_t>(width) * 4;
+	unsigned char pixels[64];
+	for(int by = 0; by < height; by += 4)
+	{
+		for(int bx = 0; bx < width; bx += 4)
+		{
+#ifdef BLOCK_COMPRESSION_X86
+			/* AVX2 takes 8 whole blocks at a time, what's left of the row goes through SSE2 */
+			if(encoder == BlockEncoder::AVX2 && by + 4 <= height && bx + BlocksPerBatch * 4 <= width)
+			{
+				encodeBlocksAVX2(rgba + by * stride + bx * 4, stride, format, out);
+				out += BlocksPerBatch * blockSize;
+				bx += (BlocksPerBatch - 1) * 4;
+				continue;
+			}
+#endif
+			if(bx + 4 <= width && by + 4 <= height)
+			{
+				// whole blocks are 4 rows of 16 bytes
+				for(int y = 0; y < 4; y++)
+					std::memcpy(pixels + y * 16, rgba + (by + y) * stride + bx * 4, 16);
+			}
+			else
+			{
+				// blocks hanging over the edge repeat the last row and column
+				for(int y = 0; y < 4; y++)
+				{
+					int sy = std::min(by + y, height - 1);
+					for(int x = 0; x < 4; x++)
+					{
+						int sx = std::min(bx + x, width - 1);
+						std::memcpy(pixels + (y * 4 + x) * 4, rgba + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+					}
+				}
+			}
+			encode(pixels, out);
+			out += blockSize;
+		}
+	}
+	return true;
+}
+
+CompressedImage compressImage(const Image& image, unsigned int format, BlockEncoder encoder)
+{
+	return compressImage(image, {}, format, encoder);
+}
+
+CompressedImage compressImage(const Image& image, const std::vector<Image>& mipLevels, unsigned int format, BlockEncoder encoder)
+{
+	CompressedImage compressed(format);
+	if(!image.isValid() || image.getFormat() != PixelFormat::RGBA8)
+		return {};
+
+	for(size_t i = 0; i <= mipLevels.size(); i++)
+	{
+		const Image& level = i == 0 ? image : mipLevels[i - 1];
+		unsigned char* blocks = compressed.addLevel(level.getWidth(), level.getHeight());
+		if(!compressLevel(level.getPixels(), level.getWidth(), level.getHeight(), format, blocks, encoder))
+			return {};
+	}
+	return compressed;
+}
+
+namespace
+{
+	void decodeBC1Block(const unsigned char* block, unsigned char* rgba)
+	{
+		uint16_t color0 = static_cast<uint16_t>(block[0] | block[1] << 8);
+		uint16_t color1 = static_cast<uint16_t>(block[2] | block[3] << 8);
+		int palette[4][4];
+		unpackRGB565(color0, palette[0]);
+		unpackRGB565(color1, palette[1]);
+		palette[0][3] = palette[1][3] = palette[2][3] = 255;
+		for(int c = 0; c < 3; c++)
+		{
+			if(color0 > color1)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		palette[3][3] = color0 > color1 ? 255 : 0;
+
+		uint32_t indices;
+		std::memcpy(&indices, block + 4, 4);
+		for(int i = 0; i < 16; i++)
+			for(int c = 0; c < 4; c++)
+				rgba[i * 4 + c] = static_cast<unsigned char>(palette[indices >> (i * 2) & 3][c]);
+	}
+
+	void decodeBC4Block(const unsigned char* block, int channel, unsigned char* rgba)
+	{
+		int palette[8] = {block[0], block[1]};
+		if(block[0] > block[1])
+		{
+			for(int k = 1; k <= 6; k++)
+				palette[k + 1] = ((7 - k) * block[0] + k * block[1]) / 7;
+		}
+		else
+		{
+			for(int k = 1; k <= 4; k++)
+				palette[k + 1] = ((5 - k) * block[0] + k * block[1]) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t indices = 0;
+		for(int byte = 0; byte < 6; byte++)
+			indices |= static_cast<uint64_t>(block[2 + byte]) << (byte * 8);
+		for(int i = 0; i < 16; i++)
+			rgba[i * 4 + channel] = static_cast<unsigned char>(palette[indices >> (i * 3) & 7]);
+	}
+}
+
+bool decompressLevel(const unsigned char* blocks, int width, int height, unsigned int format, unsigned char* rgba)
+{
+	switch(format)
+	{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_RED_RGTC1:
+		case GL_COMPRESSED_RG_RGTC2:
+			break;
+		default: return false;
+	}
+	const unsigned int blockSize = CompressedImage::getBlockSize(format);
+
+	unsigned char pixels[64];
+	for(int by = 0; by < height; by += 4)
+	{
+		for(int bx = 0; bx < width; bx += 4)
+		{
+			switch(format)
+			{
+				case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+				case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+					decodeBC1Block(blocks, pixels);
+					break;
+				case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+					decodeBC1Block(blocks + 8, pixels);
+					decodeBC4Block(blocks, 3, pixels);
+					break;
+				case GL_COMPRESSED_RED_RGTC1:
+					std::memset(pixels, 0, sizeof(pixels));
+					for(int i = 0; i < 16; i++)
+						pixels[i * 4 + 3] = 255;
+					decodeBC4Block(blocks, 0, pixels);
+					break;
+				case GL_COMPRESSED_RG_RGTC2:
+					std::memset(pixels, 0, sizeof(pixels));
+					for(int i = 0; i < 16; i++)
+						pixels[i * 4 + 3] = 255;
+					decodeBC4Block(blocks, 0, pixels);
+					decodeBC4Block(blocks + 8, 1, pixels);
+					break;
+			}
+			blocks += blockSize;
+
+			// the parts of edge blocks outside the image are dropped
+			for(int y = 0; y < 4 && by + y < height; y++)
+			{
+				int columns = std::min(4, width - bx);
+				std::memcpy(rgba + (static_cast<size_t>(by + y) * width + bx) * 4, pixels + y * 16, columns * 4);
+			}
+		}
+	}
+	return true;
+}
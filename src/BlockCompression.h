@@ -0,0 +1,64 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_BLOCKCOMPRESSION_H
+#define OPENGL_THECHERNO_BLOCKCOMPRESSION_H
+
+#include <vector>
+#include "CompressedImage.h"
+
+class Image;
+
+/* Encoders for the block compressed formats. Every format works on 4x4 pixel blocks:
+ *
+ *   BC1  8 bytes,  two 565 colors and a 2 bit index per pixel picking one of 4 colors on the line between them
+ *   BC4  8 bytes,  the same idea for one channel: two 8 bit values and 3 bit indices into 8 steps between them
+ *   BC3  16 bytes, a BC4 block for alpha followed by a BC1 block for the color
+ *   BC5  16 bytes, two BC4 blocks, one for red and one for green (normal maps)
+ *
+ * The endpoints are found by range fit: the line is the principal axis of the block's colors through their
+ * mean, and the endpoints are the outermost projections onto it. It's quick and good enough for most textures.
+ * BC7 is loaded from files but not encoded here.
+ *
+ * Whole levels go through SSE2 or AVX2 versions of the encoders when the cpu has them, quick enough
+ * to compress textures while they load (see TextureLoader::setCompressOnLoad()).
+ * */
+
+enum class BlockEncoder
+{
+	Scalar, // the encode*Block() functions below
+	SSE2,
+	AVX2
+};
+
+/* the fastest encoder this cpu runs, checked once */
+BlockEncoder getBestBlockEncoder();
+bool isBlockEncoderSupported(BlockEncoder encoder);
+const char* getBlockEncoderName(BlockEncoder encoder);
+
+/* rgba points at 16 pixels (64 bytes) in row order */
+void encodeBC1Block(const unsigned char* rgba, unsigned char* block);
+void encodeBC3Block(const unsigned char* rgba, unsigned char* block);
+/* encodes one channel (0 = red ... 3 = alpha) of the 16 rgba pixels */
+void encodeBC4Block(const unsigned char* rgba, int channel, unsigned char* block);
+void encodeBC5Block(const unsigned char* rgba, unsigned char* block);
+
+/* Compresses an RGBA8 level of any size into out, which needs CompressedImage::getLevelSize() bytes.
+ * format is the opengl format: GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, ..._DXT5_EXT, GL_COMPRESSED_RED_RGTC1
+ * or GL_COMPRESSED_RG_RGTC2. Returns false for other formats. An encoder the cpu doesn't support
+ * falls back to the best one it does */
+bool compressLevel(const unsigned char* rgba, int width, int height, unsigned int format, unsigned char* out,
+				   BlockEncoder encoder = getBestBlockEncoder());
+
+/* a single level CompressedImage of the image, which has to be RGBA8. An invalid one otherwise */
+CompressedImage compressImage(const Image& image, unsigned int format, BlockEncoder encoder = getBestBlockEncoder());
+/* the image and its mip levels (see generateMipChain()), level 1 first */
+CompressedImage compressImage(const Image& image, const std::vector<Image>& mipLevels, unsigned int format,
+							  BlockEncoder encoder = getBestBlockEncoder());
+
+/* Decodes a level back to RGBA8, the way the gpu would. For the formats compressLevel() takes,
+ * used to measure how much an encoder loses */
+bool decompressLevel(const unsigned char* blocks, int width, int height, unsigned int format, unsigned char* rgba);
+
+#endif //OPENGL_THECHERNO_BLOCKCOMPRESSION_H
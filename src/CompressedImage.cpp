@@ -0,0 +1,398 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "CompressedImage.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+	constexpr uint32_t fourCC(char a, char b, char c, char d)
+	{
+		return static_cast<uint32_t>(a) | static_cast<uint32_t>(b) << 8 | static_cast<uint32_t>(c) << 16
+			| static_cast<uint32_t>(d) << 24;
+	}
+
+	/* The DDS header, see "DDS_HEADER structure" in the DirectX docs. Everything is little endian */
+	struct DDSPixelFormat
+	{
+		uint32_t size, flags, fourCC, rgbBitCount, rMask, gMask, bMask, aMask;
+	};
+
+	struct DDSHeader
+	{
+		uint32_t size, flags, height, width, pitchOrLinearSize, depth, mipMapCount;
+		uint32_t reserved1[11];
+		DDSPixelFormat pixelFormat;
+		uint32_t caps, caps2, caps3, caps4, reserved2;
+	};
+
+	// follows DDSHeader when the fourCC is "DX10"
+	struct DDSHeaderDX10
+	{
+		uint32_t dxgiFormat, resourceDimension, miscFlag, arraySize, miscFlags2;
+	};
+
+	constexpr uint32_t DDSMagic = fourCC('D', 'D', 'S', ' ');
+	constexpr uint32_t DDSCaps = 0x1, DDSHeight = 0x2, DDSWidth = 0x4, DDSPixelFormatFlag = 0x1000;
+	constexpr uint32_t DDSMipMapCount = 0x20000, DDSLinearSize = 0x80000;
+	constexpr uint32_t DDSFourCCFlag = 0x4;
+	constexpr uint32_t DDSCapsTexture = 0x1000, DDSCapsComplex = 0x8, DDSCapsMipMap = 0x400000;
+
+	struct KTX2Header
+	{
+		uint8_t identifier[12];
+		uint32_t vkFormat, typeSize, pixelWidth, pixelHeight, pixelDepth;
+		uint32_t layerCount, faceCount, levelCount, supercompressionScheme;
+		uint32_t dfdByteOffset, dfdByteLength, kvdByteOffset, kvdByteLength;
+		uint64_t sgdByteOffset, sgdByteLength;
+	};
+
+	struct KTX2Level
+	{
+		uint64_t byteOffset, byteLength, uncompressedByteLength;
+	};
+
+	const uint8_t KTX2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+	unsigned int formatFromDXGI(uint32_t dxgiFormat)
+	{
+		switch(dxgiFormat)
+		{
+			case 71: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; // DXGI_FORMAT_BC1_UNORM
+			case 72: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; // BC1_UNORM_SRGB
+			case 77: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; // BC3_UNORM
+			case 78: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; // BC3_UNORM_SRGB
+			case 80: return GL_COMPRESSED_RED_RGTC1; // BC4_UNORM
+			case 83: return GL_COMPRESSED_RG_RGTC2; // BC5_UNORM
+			case 98: return GL_COMPRESSED_RGBA_BPTC_UNORM; // BC7_UNORM
+			case 99: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; // BC7_UNORM_SRGB
+		}
+		return 0;
+	}
+
+	unsigned int formatFromFourCC(uint32_t code)
+	{
+		switch(code)
+		{
+			case fourCC('D', 'X', 'T', '1'): return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+			case fourCC('D', 'X', 'T', '5'): return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			case fourCC('A', 'T', 'I', '1'):
+			case fourCC('B', 'C', '4', 'U'): return GL_COMPRESSED_RED_RGTC1;
+			case fourCC('A', 'T', 'I', '2'):
+			case fourCC('B', 'C', '5', 'U'): return GL_COMPRESSED_RG_RGTC2;
+		}
+		return 0;
+	}
+
+	unsigned int formatFromVulkan(uint32_t vkFormat)
+	{
+		switch(vkFormat)
+		{
+			case 131: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT; // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+			case 132: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT; // BC1_RGB_SRGB_BLOCK
+			case 133: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; // BC1_RGBA_UNORM_BLOCK
+			case 134: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; // BC1_RGBA_SRGB_BLOCK
+			case 137: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; // BC3_UNORM_BLOCK
+			case 138: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; // BC3_SRGB_BLOCK
+			case 139: return GL_COMPRESSED_RED_RGTC1; // BC4_UNORM_BLOCK
+			case 141: return GL_COMPRESSED_RG_RGTC2; // BC5_UNORM_BLOCK
+			case 145: return GL_COMPRESSED_RGBA_BPTC_UNORM; // BC7_UNORM_BLOCK
+			case 146: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; // BC7_SRGB_BLOCK
+		}
+		return 0;
+	}
+
+	bool readFile(const std::string& filePath, std::vector<unsigned char>& data)
+	{
+		std::ifstream stream(filePath, std::ios::binary);
+		if(!stream)
+			return false;
+		data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	/* The header's size and level count are the file's word only. A size opengl can't take, or more levels
+	 * than halving the size down to 1x1 gives, would make glCompressedTexImage2D fail */
+	bool checkDimensions(const std::string& filePath, uint32_t width, uint32_t height, uint32_t levelCount)
+	{
+		const auto maxSize = static_cast<uint32_t>(CompressedImage::MaxSize);
+		if(width == 0 || height == 0 || width > maxSize || height > maxSize)
+		{
+			std::cout << "'" << filePath << "' is " << width << "x" << height << ", we load sizes from 1 to "
+					  << maxSize << std::endl;
+			return false;
+		}
+
+		uint32_t maxLevels = 1;
+		for(uint32_t size = std::max(width, height); size > 1; size /= 2)
+			maxLevels++;
+		if(levelCount > maxLevels)
+		{
+			std::cout << "'" << filePath << "' has " << levelCount << " mip levels, a " << width << "x" << height
+					  << " image can't have more than " << maxLevels << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
+
+CompressedImage::CompressedImage()
+	: m_Format(0)
+{
+}
+
+CompressedImage::CompressedImage(const std::string& filePath)
+	: m_Format(0)
+{
+	std::string extension = filePath.substr(std::min(filePath.size(), filePath.find_last_of('.')));
+	bool loaded = extension == ".ktx2" ? parseKTX2(filePath) : parseDDS(filePath);
+	if(!loaded)
+	{
+		m_Format = 0;
+		m_Levels.clear();
+		m_Data.clear();
+	}
+}
+
+CompressedImage::CompressedImage(unsigned int format)
+	: m_Format(format)
+{
+}
+
+bool CompressedImage::isCompressedFile(const std::string& filePath)
+{
+	size_t dot = filePath.find_last_of('.');
+	if(dot == std::string::npos)
+		return false;
+	std::string extension = filePath.substr(dot);
+	return extension == ".dds" || extension == ".ktx2";
+}
+
+unsigned int CompressedImage::getBlockSize(unsigned int format)
+{
+	switch(format)
+	{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RED_RGTC1:
+			return 8;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_RG_RGTC2:
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+			return 16;
+	}
+	return 0;
+}
+
+size_t CompressedImage::getLevelSize(unsigned int format, int width, int height)
+{
+	// every level is made of whole 4x4 blocks, even the 2x2 and 1x1 ones
+	size_t blocksWide = std::max(1, (width + 3) / 4);
+	size_t blocksHigh = std::max(1, (height + 3) / 4);
+	return blocksWide * blocksHigh * getBlockSize(format);
+}
+
+unsigned char* CompressedImage::addLevel(int width, int height)
+{
+	size_t size = getLevelSize(m_Format, width, height);
+	m_Levels.push_back({width, height, m_Data.size(), size});
+	m_Data.resize(m_Data.size() + size);
+	return m_Data.data() + m_Levels.back().offset;
+}
+
+size_t CompressedImage::getSize() const
+{
+	size_t size = 0;
+	for(const CompressedLevel& level : m_Levels)
+		size += level.size;
+	return size;
+}
+
+bool CompressedImage::parseDDS(const std::string& filePath)
+{
+	if(!readFile(filePath, m_Data))
+	{
+		std::cout << "Failed to open '" << filePath << "'" << std::endl;
+		return false;
+	}
+
+	uint32_t magic = 0;
+	DDSHeader header{};
+	if(m_Data.size() < sizeof(magic) + sizeof(header))
+		return false;
+	std::memcpy(&magic, m_Data.data(), sizeof(magic));
+	std::memcpy(&header, m_Data.data() + sizeof(magic), sizeof(header));
+	if(magic != DDSMagic || header.size != sizeof(DDSHeader))
+	{
+		std::cout << "'" << filePath << "' is not a DDS file" << std::endl;
+		return false;
+	}
+
+	size_t offset = sizeof(magic) + sizeof(header);
+	if(header.pixelFormat.flags & DDSFourCCFlag)
+	{
+		if(header.pixelFormat.fourCC == fourCC('D', 'X', '1', '0'))
+		{
+			DDSHeaderDX10 dx10{};
+			if(m_Data.size() < offset + sizeof(dx10))
+				return false;
+			std::memcpy(&dx10, m_Data.data() + offset, sizeof(dx10));
+			offset += sizeof(dx10);
+			m_Format = formatFromDXGI(dx10.dxgiFormat);
+		}
+		else
+		{
+			m_Format = formatFromFourCC(header.pixelFormat.fourCC);
+		}
+	}
+	if(m_Format == 0)
+	{
+		std::cout << "'" << filePath << "' is not in a block compressed format we know (BC1, BC3, BC4, BC5, BC7)" << std::endl;
+		return false;
+	}
+
+	uint32_t levelCount = std::max(1u, header.mipMapCount);
+	if(!checkDimensions(filePath, header.width, header.height, levelCount))
+		return false;
+	int width = static_cast<int>(header.width);
+	int height = static_cast<int>(header.height);
+	for(uint32_t level = 0; level < levelCount; level++)
+	{
+		size_t size = getLevelSize(m_Format, width, height);
+		if(offset + size > m_Data.size())
+		{
+			std::cout << "'" << filePath << "' is cut short" << std::endl;
+			return false;
+		}
+		m_Levels.push_back({width, height, offset, size});
+		offset += size;
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+	return true;
+}
+
+bool CompressedImage::parseKTX2(const std::string& filePath)
+{
+	if(!readFile(filePath, m_Data))
+	{
+		std::cout << "Failed to open '" << filePath << "'" << std::endl;
+		return false;
+	}
+
+	KTX2Header header{};
+	if(m_Data.size() < sizeof(header))
+		return false;
+	std::memcpy(&header, m_Data.data(), sizeof(header));
+	if(std::memcmp(header.identifier, KTX2Identifier, sizeof(KTX2Identifier)) != 0)
+	{
+		std::cout << "'" << filePath << "' is not a KTX2 file" << std::endl;
+		return false;
+	}
+
+	/* Basis Universal and zstd supercompressed files would need a transcoder first */
+	if(header.supercompressionScheme != 0)
+	{
+		std::cout << "'" << filePath << "' is supercompressed, we only load plain block compressed KTX2" << std::endl;
+		return false;
+	}
+	if(header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1)
+	{
+		std::cout << "'" << filePath << "' is not a plain 2D texture" << std::endl;
+		return false;
+	}
+
+	m_Format = formatFromVulkan(header.vkFormat);
+	if(m_Format == 0)
+	{
+		std::cout << "'" << filePath << "' is not in a block compressed format we know (BC1, BC3, BC4, BC5, BC7)" << std::endl;
+		return false;
+	}
+
+	// the level index follows the header, level 0 first (even though its data is last in the file)
+	uint32_t levelCount = std::max(1u, header.levelCount);
+	// a height of 0 is a 1D texture, which we load as a single row
+	if(!checkDimensions(filePath, header.pixelWidth, std::max(1u, header.pixelHeight), levelCount))
+		return false;
+	if(m_Data.size() < sizeof(header) + levelCount * sizeof(KTX2Level))
+		return false;
+
+	int width = static_cast<int>(header.pixelWidth);
+	int height = static_cast<int>(std::max(1u, header.pixelHeight));
+	for(uint32_t level = 0; level < levelCount; level++)
+	{
+		KTX2Level index{};
+		std::memcpy(&index, m_Data.data() + sizeof(header) + level * sizeof(KTX2Level), sizeof(index));
+		if(index.byteOffset > m_Data.size() || index.byteLength > m_Data.size() - index.byteOffset
+			|| index.byteLength != getLevelSize(m_Format, width, height))
+		{
+			std::cout << "'" << filePath << "' has a broken level " << level << std::endl;
+			return false;
+		}
+		m_Levels.push_back({width, height, static_cast<size_t>(index.byteOffset), static_cast<size_t>(index.byteLength)});
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+	return true;
+}
+
+bool CompressedImage::writeDDS(const std::string& filePath) const
+{
+	if(!isValid())
+		return false;
+
+	DDSHeader header{};
+	header.size = sizeof(DDSHeader);
+	header.flags = DDSCaps | DDSHeight | DDSWidth | DDSPixelFormatFlag | DDSLinearSize
+		| (m_Levels.size() > 1 ? DDSMipMapCount : 0);
+	header.width = getWidth();
+	header.height = getHeight();
+	header.pitchOrLinearSize = m_Levels[0].size;
+	header.mipMapCount = m_Levels.size();
+	header.pixelFormat.size = sizeof(DDSPixelFormat);
+	header.pixelFormat.flags = DDSFourCCFlag;
+	header.caps = DDSCapsTexture | (m_Levels.size() > 1 ? DDSCapsComplex | DDSCapsMipMap : 0);
+
+	/* the old fourCCs for the formats that have one, everything else needs the DX10 header */
+	DDSHeaderDX10 dx10{};
+	bool needsDX10 = false;
+	switch(m_Format)
+	{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:	header.pixelFormat.fourCC = fourCC('D', 'X', 'T', '1'); break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:	header.pixelFormat.fourCC = fourCC('D', 'X', 'T', '5'); break;
+		case GL_COMPRESSED_RED_RGTC1:			header.pixelFormat.fourCC = fourCC('B', 'C', '4', 'U'); break;
+		case GL_COMPRESSED_RG_RGTC2:			header.pixelFormat.fourCC = fourCC('B', 'C', '5', 'U'); break;
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:		needsDX10 = true; dx10.dxgiFormat = 98; break;
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:	needsDX10 = true; dx10.dxgiFormat = 99; break;
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:	needsDX10 = true; dx10.dxgiFormat = 72; break;
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:	needsDX10 = true; dx10.dxgiFormat = 78; break;
+		default: return false;
+	}
+	if(needsDX10)
+	{
+		header.pixelFormat.fourCC = fourCC('D', 'X', '1', '0');
+		dx10.resourceDimension = 3; // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+		dx10.arraySize = 1;
+	}
+
+	std::ofstream stream(filePath, std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char*>(&DDSMagic), sizeof(DDSMagic));
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if(needsDX10)
+		stream.write(reinterpret_cast<const char*>(&dx10), sizeof(dx10));
+	for(unsigned int level = 0; level < m_Levels.size(); level++)
+		stream.write(reinterpret_cast<const char*>(getLevelData(level)), m_Levels[level].size);
+	return static_cast<bool>(stream);
+}
@@ -0,0 +1,66 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_COMPRESSEDIMAGE_H
+#define OPENGL_THECHERNO_COMPRESSEDIMAGE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct CompressedLevel
+{
+	int width, height;
+	size_t offset; // into the image's data
+	size_t size;
+};
+
+/* Block compressed pixels (BC1, BC3, BC4, BC5 or BC7) with their mip levels, ready for glCompressedTexImage2D.
+ * They come from a .dds or .ktx2 file or from our own encoder (BlockCompression.h).
+ *
+ * Like Image, the rows are expected bottom row first. tools/TextureCompressor writes them that way,
+ * files from other tools are usually top row first and will show upside down
+ * */
+class CompressedImage
+{
+private:
+	unsigned int m_Format; // the opengl internal format, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT for example. 0 if invalid
+	std::vector<CompressedLevel> m_Levels; // level 0 is the full size image
+	std::vector<unsigned char> m_Data;
+public:
+	/* the largest width or height we load. Most drivers go this far, Texture checks the real limit at upload */
+	static constexpr int MaxSize = 16384;
+
+	CompressedImage();
+	explicit CompressedImage(const std::string& filePath);
+	/* an empty image, the levels are added with addLevel() */
+	explicit CompressedImage(unsigned int format);
+
+	/* true for the file extensions we load here (.dds and .ktx2) */
+	static bool isCompressedFile(const std::string& filePath);
+	/* bytes per 4x4 block, 0 for formats we don't know */
+	static unsigned int getBlockSize(unsigned int format);
+	static size_t getLevelSize(unsigned int format, int width, int height);
+
+	/* appends a level and returns where its blocks go */
+	unsigned char* addLevel(int width, int height);
+
+	bool writeDDS(const std::string& filePath) const;
+
+	inline bool isValid() const { return m_Format != 0 && !m_Levels.empty(); }
+	inline unsigned int getFormat() const { return m_Format; }
+	inline int getWidth() const { return m_Levels.empty() ? 0 : m_Levels[0].width; }
+	inline int getHeight() const { return m_Levels.empty() ? 0 : m_Levels[0].height; }
+	inline unsigned int getLevelCount() const { return m_Levels.size(); }
+	inline const CompressedLevel& getLevel(unsigned int level) const { return m_Levels[level]; }
+	inline const unsigned char* getLevelData(unsigned int level) const { return m_Data.data() + m_Levels[level].offset; }
+	size_t getSize() const;
+
+private:
+	bool parseDDS(const std::string& filePath);
+	bool parseKTX2(const std::string& filePath);
+};
+
+
+#endif //OPENGL_THECHERNO_COMPRESSEDIMAGE_H
@@ -0,0 +1,148 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "FrameTimer.h"
+#include <algorithm>
+#include <bit>
+#include <iomanip>
+#include <iostream>
+
+TimeHistogram::TimeHistogram()
+	: m_Counts(getIndex(UINT64_MAX) + 1, 0), m_TotalCount(0), m_Max(0), m_Sum(0.0)
+{
+}
+
+/* Below 128 the value is the index. Above, the top 7 bits of the value (64 to 127) pick one of 64 buckets
+ * of its power of two, and the power of two is how far we had to shift to get those bits */
+size_t TimeHistogram::getIndex(uint64_t value)
+{
+	if(value < (1u << SubBucketBits))
+		return static_cast<size_t>(value);
+	const int shift = std::bit_width(value) - SubBucketBits;
+	return (1u << SubBucketBits) + static_cast<size_t>(shift - 1) * SubBucketHalf + static_cast<size_t>((value >> shift) - SubBucketHalf);
+}
+
+uint64_t TimeHistogram::getHighestValue(size_t index)
+{
+	if(index < (1u << SubBucketBits))
+		return index;
+	const size_t bucket = index - (1u << SubBucketBits);
+	const int shift = static_cast<int>(bucket / SubBucketHalf) + 1;
+	const uint64_t lowest = static_cast<uint64_t>(bucket % SubBucketHalf + SubBucketHalf) << shift;
+	return lowest + ((uint64_t(1) << shift) - 1);
+}
+
+void TimeHistogram::record(uint64_t nanoseconds)
+{
+	m_Counts[getIndex(nanoseconds)]++;
+	m_TotalCount++;
+	m_Max = std::max(m_Max, nanoseconds);
+	m_Sum += static_cast<double>(nanoseconds);
+}
+
+void TimeHistogram::reset()
+{
+	std::fill(m_Counts.begin(), m_Counts.end(), 0);
+	m_TotalCount = 0;
+	m_Max = 0;
+	m_Sum = 0.0;
+}
+
+double TimeHistogram::getPercentile(double p) const
+{
+	if(m_TotalCount == 0)
+		return 0.0;
+	// the smallest value that at least p percent of the values are at or below
+	const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(m_TotalCount) + 0.5));
+	uint64_t seen = 0;
+	for(size_t i = 0; i < m_Counts.size(); i++)
+	{
+		seen += m_Counts[i];
+		if(seen >= target)
+			return static_cast<double>(std::min(getHighestValue(i), m_Max)) / 1e6;
+	}
+	return getMax();
+}
+
+double TimeHistogram::getMean() const
+{
+	return m_TotalCount ? m_Sum / static_cast<double>(m_TotalCount) / 1e6 : 0.0;
+}
+
+FrameTimer::FrameTimer(size_t worstCount)
+	: m_Running(false), m_Current{}, m_WorstCount(worstCount)
+{
+}
+
+void FrameTimer::beginFrame()
+{
+	const Clock::time_point now = Clock::now();
+	if(m_Running)
+	{
+		// the previous frame ends where this one begins
+		m_Current.frameMs = std::chrono::duration<double, std::milli>(now - m_FrameBegin).count();
+		m_Frame.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_FrameBegin).count()));
+
+		if(m_Worst.size() < m_WorstCount || m_Current.frameMs > m_Worst.back().frameMs)
+		{
+			auto position = std::upper_bound(m_Worst.begin(), m_Worst.end(), m_Current,
+					[](const FrameRecord& a, const FrameRecord& b) { return a.frameMs > b.frameMs; });
+			m_Worst.insert(position, m_Current);
+			if(m_Worst.size() > m_WorstCount)
+				m_Worst.pop_back();
+		}
+	}
+	m_FrameBegin = now;
+	m_Running = true;
+	m_Current = {};
+}
+
+void FrameTimer::beginSwap()
+{
+	m_SwapBegin = Clock::now();
+	m_Current.cpuMs = std::chrono::duration<double, std::milli>(m_SwapBegin - m_FrameBegin).count();
+	m_Cpu.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(m_SwapBegin - m_FrameBegin).count()));
+}
+
+void FrameTimer::endSwap()
+{
+	const Clock::time_point now = Clock::now();
+	m_Current.swapMs = std::chrono::duration<double, std::milli>(now - m_SwapBegin).count();
+	m_Swap.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_SwapBegin).count()));
+	m_Current.stats = RenderStats::getLastFrame();
+}
+
+void FrameTimer::reset()
+{
+	m_Cpu.reset();
+	m_Swap.reset();
+	m_Frame.reset();
+	m_Worst.clear();
+	m_Running = false;
+}
+
+void FrameTimer::printReport() const
+{
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Frame times over " << m_Frame.getCount() << " frames (ms)     mean       p50       p90       p99     p99.9       max" << std::endl;
+	const std::pair<const char*, const TimeHistogram*> histograms[] = {{"cpu", &m_Cpu}, {"swap", &m_Swap}, {"frame", &m_Frame}};
+	for(const auto& [name, histogram] : histograms)
+	{
+		std::cout << "  " << std::left << std::setw(31) << name << std::right << std::setw(9) << histogram->getMean();
+		for(double p : {50.0, 90.0, 99.0, 99.9})
+			std::cout << std::setw(10) << histogram->getPercentile(p);
+		std::cout << std::setw(10) << histogram->getMax() << std::endl;
+	}
+
+	std::cout << "Worst frames" << std::endl;
+	for(const FrameRecord& record : m_Worst)
+	{
+		std::cout << "  frame " << record.stats.frame << ": " << record.frameMs << " ms (cpu " << record.cpuMs << ", swap " << record.swapMs
+				  << "), " << record.stats.drawCalls << " draws, " << record.stats.triangles << " triangles, "
+				  << record.stats.programBinds << " program / " << record.stats.textureBinds << " texture binds, "
+				  << record.stats.uniformUploads << " uniforms, " << record.stats.bufferBytes / 1024 << " KB buffers, "
+				  << record.stats.textureBytes / 1024 << " KB textures" << std::endl;
+	}
+	std::cout << std::defaultfloat;
+}
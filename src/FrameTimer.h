@@ -0,0 +1,94 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_FRAMETIMER_H
+#define OPENGL_THECHERNO_FRAMETIMER_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "RenderStats.h"
+
+/* Counts durations in buckets that are 1/64 of their power of two wide, like HdrHistogram does: any
+ * duration from a nanosecond to years is kept to within 1.6%, in a fixed 30 KB, and recording is a
+ * couple of shifts. Percentiles come out as the upper end of their bucket */
+class TimeHistogram
+{
+private:
+	static constexpr int SubBucketBits = 7; // values below 128 have a bucket each
+	static constexpr int SubBucketHalf = 1 << (SubBucketBits - 1);
+
+	std::vector<uint64_t> m_Counts;
+	uint64_t m_TotalCount;
+	uint64_t m_Max;
+	double m_Sum;
+public:
+	TimeHistogram();
+
+	void record(uint64_t nanoseconds);
+	void reset();
+
+	/* p from 0 to 100, in milliseconds */
+	double getPercentile(double p) const;
+	double getMean() const;
+	inline double getMax() const { return static_cast<double>(m_Max) / 1e6; }
+	inline uint64_t getCount() const { return m_TotalCount; }
+
+private:
+	static size_t getIndex(uint64_t value);
+	static uint64_t getHighestValue(size_t index);
+};
+
+/* Frame pacing of the main loop:
+ *
+ *     while(...)
+ *     {
+ *         frameTimer.beginFrame();
+ *         ... // update and draw
+ *         frameTimer.beginSwap();
+ *         glfwSwapBuffers(window);
+ *         frameTimer.endSwap();
+ *     }
+ *
+ * cpu is from beginFrame() to beginSwap(), swap is how long the swap blocked us (with vsync mostly waiting
+ * for the display), and frame is from one beginFrame() to the next, what the user sees. With vsync on frame
+ * is always the refresh interval, whatever the rest costs, so benchmark without it.
+ * The slowest frames are kept with the RenderStats of the frame, call RenderStats::endFrame() before endSwap() */
+class FrameTimer
+{
+public:
+	struct FrameRecord
+	{
+		double cpuMs, swapMs, frameMs;
+		FrameStats stats;
+	};
+private:
+	using Clock = std::chrono::steady_clock;
+
+	TimeHistogram m_Cpu, m_Swap, m_Frame;
+	Clock::time_point m_FrameBegin, m_SwapBegin;
+	bool m_Running;
+	FrameRecord m_Current;
+	size_t m_WorstCount;
+	std::vector<FrameRecord> m_Worst; // the slowest, by frameMs, slowest first
+public:
+	explicit FrameTimer(size_t worstCount = 5);
+
+	void beginFrame();
+	void beginSwap();
+	void endSwap();
+	/* starts over, e.g. after loading */
+	void reset();
+
+	inline const TimeHistogram& getCpuTimes() const { return m_Cpu; }
+	inline const TimeHistogram& getSwapTimes() const { return m_Swap; }
+	inline const TimeHistogram& getFrameTimes() const { return m_Frame; }
+	inline const std::vector<FrameRecord>& getWorstFrames() const { return m_Worst; }
+
+	/* p50, p90, p99, p99.9 and the max of all three, then the worst frames and their counters */
+	void printReport() const;
+};
+
+
+#endif //OPENGL_THECHERNO_FRAMETIMER_H
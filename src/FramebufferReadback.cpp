@@ -0,0 +1,107 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "FramebufferReadback.h"
+#include "Renderer.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+FramebufferReadback::FramebufferReadback(unsigned int slotCount)
+	: m_NextID(1)
+{
+	m_Slots.resize(slotCount);
+	for(Slot& slot : m_Slots)
+	{
+		slot = {0, 0, nullptr, 0, 0, 0};
+		glCall(glGenBuffers(1, &slot.buffer));
+	}
+}
+
+FramebufferReadback::~FramebufferReadback()
+{
+	for(Slot& slot : m_Slots)
+	{
+		if(slot.fence)
+		{
+			glCall(glDeleteSync(slot.fence));
+		}
+		glCall(glDeleteBuffers(1, &slot.buffer));
+	}
+}
+
+uint64_t FramebufferReadback::request(int x, int y, int width, int height)
+{
+	auto free = std::find_if(m_Slots.begin(), m_Slots.end(), [](const Slot& slot) { return slot.fence == nullptr; });
+	if(free == m_Slots.end())
+		return 0;
+
+	Slot& slot = *free;
+	const size_t size = static_cast<size_t>(width) * height * 4;
+	glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer));
+	if(slot.size != size)
+	{
+		// read by us and not by the gpu, and made again for every readback of this size
+		glCall(glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ));
+		slot.size = size;
+	}
+	/* with a pack buffer bound the last argument is an offset into it, the call returns as soon as the copy
+	 * is queued */
+	glCall(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+	glCall(glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+	glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+	glCall(slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+	slot.width = width;
+	slot.height = height;
+	slot.id = m_NextID++;
+	m_InFlight.push_back(static_cast<size_t>(free - m_Slots.begin()));
+	return slot.id;
+}
+
+bool FramebufferReadback::collect(uint64_t& id, Image& image)
+{
+	return finish(0, id, image);
+}
+
+bool FramebufferReadback::wait(uint64_t& id, Image& image)
+{
+	// a second is forever for a copy, if it takes that long something is wrong
+	return finish(1000000000ull, id, image);
+}
+
+bool FramebufferReadback::finish(uint64_t timeout, uint64_t& id, Image& image)
+{
+	if(m_InFlight.empty())
+		return false;
+
+	Slot& slot = m_Slots[m_InFlight.front()];
+	/* the flush makes sure the fence gets to the gpu at all, or asking again and again could never see it
+	 * signalled. With a timeout of 0 it only asks */
+	glCall(GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout));
+	if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		return false;
+	glCall(glDeleteSync(slot.fence));
+	slot.fence = nullptr;
+	m_InFlight.pop_front();
+
+	image = Image(slot.width, slot.height);
+	glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer));
+	glCall(const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.size, GL_MAP_READ_BIT));
+	if(pixels)
+	{
+		std::memcpy(image.getPixels(), pixels, slot.size);
+		glCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+	}
+	else
+	{
+		std::cout << "FramebufferReadback: can't map the pixels of readback " << slot.id << std::endl;
+		image = Image();
+	}
+	glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+	// the slot is free again either way
+	id = slot.id;
+	return true;
+}
@@ -0,0 +1,62 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_FRAMEBUFFERREADBACK_H
+#define OPENGL_THECHERNO_FRAMEBUFFERREADBACK_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "Image.h"
+
+typedef struct __GLsync* GLsync;
+
+/* Reads the framebuffer back through a ring of pixel pack buffers (PBOs), the other way round from
+ * PixelUploadRing.
+ *
+ * glReadPixels into our own memory has to wait until the gpu has drawn everything before it, and then for
+ * the copy. Into a pixel buffer it only queues the copy and returns, and a fence after it tells us when the
+ * pixels are there to be mapped. So we ask for a frame and pick it up a frame or two later, the gpu never
+ * runs dry in between. Must be used on the GL thread */
+class FramebufferReadback
+{
+private:
+	struct Slot
+	{
+		unsigned int buffer;
+		size_t size; // of the buffer's storage
+		GLsync fence; // nullptr when the slot is free
+		int width, height;
+		uint64_t id;
+	};
+
+	std::vector<Slot> m_Slots;
+	std::deque<size_t> m_InFlight; // indices into m_Slots, oldest first
+	uint64_t m_NextID;
+public:
+	explicit FramebufferReadback(unsigned int slotCount = 3);
+	~FramebufferReadback();
+
+	FramebufferReadback(const FramebufferReadback&) = delete;
+	FramebufferReadback& operator=(const FramebufferReadback&) = delete;
+
+	/* Queues a copy of the rectangle of the framebuffer bound for reading, as RGBA8. Returns the id the pixels
+	 * come back with, or 0 when every slot is still in flight */
+	uint64_t request(int x, int y, int width, int height);
+	/* The oldest readback, if the gpu is done with it. Never waits, false when there's nothing yet.
+	 * When it's true the readback is done with and id is set, but image is invalid if its pixels
+	 * couldn't be mapped */
+	bool collect(uint64_t& id, Image& image);
+	/* the oldest readback, waiting for it if it has to (up to a second). false when nothing is in flight
+	 * or it timed out */
+	bool wait(uint64_t& id, Image& image);
+
+	inline size_t getInFlightCount() const { return m_InFlight.size(); }
+
+private:
+	bool finish(uint64_t timeout, uint64_t& id, Image& image);
+};
+
+
+#endif //OPENGL_THECHERNO_FRAMEBUFFERREADBACK_H
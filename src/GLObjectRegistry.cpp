@@ -0,0 +1,160 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "GLObjectRegistry.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+	struct Registry
+	{
+		// the texture loader's textures can be let go of on its threads
+		std::mutex mutex;
+		// the types have names of their own, a buffer and a texture can both be 1
+		std::unordered_map<uint64_t, GLObjectInfo> objects;
+	};
+
+	uint64_t getKey(GLObjectType type, unsigned int name)
+	{
+		return static_cast<uint64_t>(type) << 32 | name;
+	}
+
+	/* Never destroyed: wrappers that are static objects of their own may be deleted after anything we
+	 * could destroy at exit. The leak report is registered with atexit() when the first object comes in */
+	Registry& getRegistry()
+	{
+		static Registry* registry = []() {
+			std::atexit([]() { GLObjectRegistry::reportLeaks(); });
+			return new Registry();
+		}();
+		return *registry;
+	}
+
+	void printObject(const GLObjectInfo& object, std::chrono::steady_clock::time_point now)
+	{
+		const double age = std::chrono::duration<double>(now - object.created).count();
+		std::cout << "  " << std::left << std::setw(13) << getGLObjectTypeName(object.type) << std::right << std::setw(6) << object.name
+				  << std::setw(12) << object.size << " bytes  " << std::fixed << std::setprecision(1) << std::setw(8) << age << " s, "
+				  << std::setw(6) << RenderStats::current().frame - object.createdFrame << " frames  " << object.site.file_name() << ":"
+				  << object.site.line() << std::defaultfloat << std::endl;
+	}
+}
+
+const char* getGLObjectTypeName(GLObjectType type)
+{
+	switch(type)
+	{
+		case GLObjectType::VertexBuffer: return "VertexBuffer";
+		case GLObjectType::IndexBuffer: return "IndexBuffer";
+		case GLObjectType::VertexArray: return "VertexArray";
+		case GLObjectType::Shader: return "Shader";
+		case GLObjectType::Texture: return "Texture";
+		case GLObjectType::TextureArray: return "TextureArray";
+	}
+	return "?";
+}
+
+void GLObjectRegistry::add(GLObjectType type, unsigned int name, size_t size, const std::source_location& site)
+{
+	if(name == 0)
+		return;
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.objects[getKey(type, name)] = {type, name, size, site, std::chrono::steady_clock::now(), RenderStats::current().frame};
+}
+
+void GLObjectRegistry::setSize(GLObjectType type, unsigned int name, size_t size)
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	auto object = registry.objects.find(getKey(type, name));
+	if(object != registry.objects.end())
+		object->second.size = size;
+}
+
+void GLObjectRegistry::remove(GLObjectType type, unsigned int name)
+{
+	if(name == 0)
+		return;
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	if(registry.objects.erase(getKey(type, name)) == 0)
+		std::cout << "GLObjectRegistry: " << getGLObjectTypeName(type) << " " << name << " deleted but it isn't alive" << std::endl;
+}
+
+size_t GLObjectRegistry::getLiveCount()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	return registry.objects.size();
+}
+
+size_t GLObjectRegistry::getLiveBytes()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	size_t bytes = 0;
+	for(const auto& [key, object] : registry.objects)
+		bytes += object.size;
+	return bytes;
+}
+
+std::vector<GLObjectInfo> GLObjectRegistry::getLiveObjects()
+{
+	std::vector<GLObjectInfo> objects;
+	{
+		Registry& registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		objects.reserve(registry.objects.size());
+		for(const auto& [key, object] : registry.objects)
+			objects.push_back(object);
+	}
+	std::sort(objects.begin(), objects.end(), [](const GLObjectInfo& a, const GLObjectInfo& b) { return a.created < b.created; });
+	return objects;
+}
+
+void GLObjectRegistry::printLive()
+{
+	const std::vector<GLObjectInfo> objects = getLiveObjects();
+	const auto now = std::chrono::steady_clock::now();
+
+	std::cout << objects.size() << " live GL objects" << std::endl;
+	for(GLObjectType type : {GLObjectType::VertexBuffer, GLObjectType::IndexBuffer, GLObjectType::VertexArray, GLObjectType::Shader,
+			GLObjectType::Texture, GLObjectType::TextureArray})
+	{
+		size_t count = 0, bytes = 0;
+		for(const GLObjectInfo& object : objects)
+		{
+			if(object.type == type)
+			{
+				count++;
+				bytes += object.size;
+			}
+		}
+		if(count > 0)
+			std::cout << "  " << std::left << std::setw(13) << getGLObjectTypeName(type) << std::right << std::setw(6) << count
+					  << std::setw(12) << bytes << " bytes" << std::endl;
+	}
+	for(const GLObjectInfo& object : objects)
+		printObject(object, now);
+}
+
+size_t GLObjectRegistry::reportLeaks()
+{
+	const std::vector<GLObjectInfo> objects = getLiveObjects();
+	if(objects.empty())
+		return 0;
+
+	const auto now = std::chrono::steady_clock::now();
+	std::cout << "GLObjectRegistry: " << objects.size() << " GL objects were never deleted" << std::endl;
+	for(const GLObjectInfo& object : objects)
+		printObject(object, now);
+	return objects.size();
+}
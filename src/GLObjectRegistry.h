@@ -0,0 +1,63 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_GLOBJECTREGISTRY_H
+#define OPENGL_THECHERNO_GLOBJECTREGISTRY_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <source_location>
+#include <vector>
+
+enum class GLObjectType
+{
+	VertexBuffer,
+	IndexBuffer,
+	VertexArray,
+	Shader,
+	Texture,
+	TextureArray
+};
+
+const char* getGLObjectTypeName(GLObjectType type);
+
+struct GLObjectInfo
+{
+	GLObjectType type;
+	unsigned int name; // the opengl name
+	size_t size; // bytes of video memory we know of, 0 when we don't
+	std::source_location site; // where the wrapper was constructed
+	std::chrono::steady_clock::time_point created;
+	uint64_t createdFrame; // RenderStats' frame number at the time
+};
+
+/* Every opengl object our wrappers own, from the glGen* to the glDelete*. The wrappers register themselves,
+ * with where they were constructed: their constructors take a std::source_location that defaults to the
+ * caller's line (for a make_unique or make_shared that's the line in <memory>, the frames above it are
+ * the interesting ones).
+ *
+ * Whatever is still registered when the program exits was never deleted and is reported as a leak.
+ * Registering is a hash map insert under a lock, once per object, nothing per frame */
+class GLObjectRegistry
+{
+public:
+	static void add(GLObjectType type, unsigned int name, size_t size, const std::source_location& site);
+	/* for objects whose storage changes after they're made, textures that are streamed or uploaded later */
+	static void setSize(GLObjectType type, unsigned int name, size_t size);
+	static void remove(GLObjectType type, unsigned int name);
+
+	static size_t getLiveCount();
+	static size_t getLiveBytes();
+	/* the oldest first */
+	static std::vector<GLObjectInfo> getLiveObjects();
+
+	/* counts and bytes per type, then every object with its size, creation site and age */
+	static void printLive();
+	/* prints the objects still alive, if any, as leaks and returns how many there are. Runs by itself at exit */
+	static size_t reportLeaks();
+};
+
+
+#endif //OPENGL_THECHERNO_GLOBJECTREGISTRY_H
@@ -0,0 +1,159 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "GpuProfiler.h"
+#include "Renderer.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+GpuProfiler::GpuProfiler(unsigned int frameLatency)
+	: m_Frames(std::max(2u, frameLatency)), m_Current(0), m_FrameNumber(0), m_InFrame(false),
+	m_TimerQueries(GLEW_VERSION_3_3 || GLEW_ARB_timer_query), m_DebugGroups(GLEW_VERSION_4_3 || GLEW_KHR_debug),
+	m_LastReport{0, {}}, m_SkippedFrames(0)
+{
+	if(!m_TimerQueries)
+		std::cout << "GpuProfiler: no timer queries on this driver, only cpu times are reported" << std::endl;
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	for(Frame& frame : m_Frames)
+	{
+		if(!frame.queries.empty())
+		{
+			glCall(glDeleteQueries(static_cast<int>(frame.queries.size()), frame.queries.data()));
+		}
+	}
+}
+
+void GpuProfiler::beginFrame()
+{
+	if(m_InFrame)
+		endFrame();
+
+	m_Current = (m_Current + 1) % m_Frames.size();
+	Frame& frame = m_Frames[m_Current];
+	if(frame.pending)
+		resolve(frame);
+
+	frame.usedQueries = 0;
+	frame.scopes.clear();
+	frame.open.clear();
+	frame.number = ++m_FrameNumber;
+	m_InFrame = true;
+	beginScope("Frame");
+}
+
+void GpuProfiler::endFrame()
+{
+	if(!m_InFrame)
+		return;
+	Frame& frame = m_Frames[m_Current];
+	while(!frame.open.empty())
+		endScope(); // "Frame" and whatever was left open
+	frame.pending = true;
+	m_InFrame = false;
+}
+
+void GpuProfiler::beginScope(const char* name)
+{
+	if(m_DebugGroups)
+	{
+		glCall(glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name));
+	}
+	if(!m_InFrame)
+		return;
+
+	Frame& frame = m_Frames[m_Current];
+	Scope scope{name, 0, 0, static_cast<int>(frame.open.size()), Clock::now(), {}};
+	if(m_TimerQueries)
+	{
+		scope.beginQuery = allocateQuery(frame);
+		glCall(glQueryCounter(frame.queries[scope.beginQuery], GL_TIMESTAMP));
+	}
+	frame.open.push_back(frame.scopes.size());
+	frame.scopes.push_back(scope);
+}
+
+void GpuProfiler::endScope()
+{
+	if(m_DebugGroups)
+	{
+		glCall(glPopDebugGroup());
+	}
+	if(!m_InFrame)
+		return;
+
+	Frame& frame = m_Frames[m_Current];
+	if(frame.open.empty())
+		return;
+	Scope& scope = frame.scopes[frame.open.back()];
+	frame.open.pop_back();
+	scope.cpuEnd = Clock::now();
+	if(m_TimerQueries)
+	{
+		scope.endQuery = allocateQuery(frame);
+		glCall(glQueryCounter(frame.queries[scope.endQuery], GL_TIMESTAMP));
+	}
+}
+
+unsigned int GpuProfiler::allocateQuery(Frame& frame)
+{
+	// the pool only grows, after the first few frames every frame reuses the same queries
+	if(frame.usedQueries == frame.queries.size())
+	{
+		const size_t oldSize = frame.queries.size();
+		frame.queries.resize(std::max<size_t>(32, oldSize * 2));
+		glCall(glGenQueries(static_cast<int>(frame.queries.size() - oldSize), frame.queries.data() + oldSize));
+	}
+	return static_cast<unsigned int>(frame.usedQueries++);
+}
+
+void GpuProfiler::resolve(Frame& frame)
+{
+	frame.pending = false;
+	if(m_TimerQueries && frame.usedQueries > 0)
+	{
+		/* The gpu runs the commands in order, so when the last timestamp is there all of them are.
+		 * If it isn't, the gpu is more than frameLatency frames behind: waiting would stall us, so the
+		 * frame goes unreported */
+		int available = 0;
+		glCall(glGetQueryObjectiv(frame.queries[frame.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+		if(!available)
+		{
+			m_SkippedFrames++;
+			return;
+		}
+	}
+
+	m_Timestamps.assign(frame.usedQueries, 0);
+	for(size_t i = 0; i < frame.usedQueries; i++)
+	{
+		glCall(glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &m_Timestamps[i]));
+	}
+
+	m_LastReport.frame = frame.number;
+	m_LastReport.timings.clear();
+	for(const Scope& scope : frame.scopes)
+	{
+		const double cpuMs = std::chrono::duration<double, std::milli>(scope.cpuEnd - scope.cpuBegin).count();
+		const double gpuMs = m_TimerQueries ? static_cast<double>(m_Timestamps[scope.endQuery] - m_Timestamps[scope.beginQuery]) / 1e6 : 0.0;
+		m_LastReport.timings.push_back({scope.name, scope.depth, cpuMs, gpuMs});
+	}
+}
+
+void GpuProfiler::printReport() const
+{
+	std::cout << "Frame " << m_LastReport.frame << " (" << m_SkippedFrames << " skipped)          cpu ms     gpu ms" << std::endl;
+	for(const GpuTiming& timing : m_LastReport.timings)
+	{
+		// indented with setw and not a string, so that printing doesn't allocate in the frame loop
+		const int indent = 2 * timing.depth;
+		std::cout << "  " << std::setw(indent) << "" << std::left << std::setw(std::max(0, 32 - indent)) << timing.name
+				  << std::right << std::fixed << std::setprecision(3)
+				  << std::setw(10) << timing.cpuMs << std::setw(11) << timing.gpuMs << std::endl;
+	}
+	std::cout << std::defaultfloat;
+}
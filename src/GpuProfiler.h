@@ -0,0 +1,120 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_GPUPROFILER_H
+#define OPENGL_THECHERNO_GPUPROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* how long a scope took on the cpu (issuing the commands) and on the gpu (running them) */
+struct GpuTiming
+{
+	const char* name;
+	int depth; // 0 is the frame itself
+	double cpuMs;
+	double gpuMs;
+};
+
+struct GpuFrameReport
+{
+	uint64_t frame; // the number beginFrame() gave it
+	std::vector<GpuTiming> timings; // in the order the scopes began
+};
+
+/* GPU times of named scopes, read back without ever waiting on the gpu.
+ *
+ * Each scope puts a timestamp query (glQueryCounter) into the command stream where it begins and one where
+ * it ends, so scopes can nest, which GL_TIME_ELAPSED queries can't. The gpu writes the timestamps when
+ * it gets there, a frame or two later. The queries of a frame are only read when its slot in the ring
+ * comes round again, frameLatency frames on, and if the gpu still isn't done by then the frame is skipped
+ * rather than waited for.
+ *
+ * The scopes are also pushed as debug groups (KHR_debug), so RenderDoc and the driver tools show the same
+ * names. Every scope takes the cpu time in between too, and the report has both side by side. Scopes
+ * begun outside beginFrame()/endFrame() only push the debug group */
+class GpuProfiler
+{
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Scope
+	{
+		const char* name;
+		unsigned int beginQuery, endQuery; // indices into the frame's queries
+		int depth;
+		Clock::time_point cpuBegin, cpuEnd;
+	};
+
+	struct Frame
+	{
+		std::vector<unsigned int> queries;
+		size_t usedQueries = 0;
+		std::vector<Scope> scopes;
+		std::vector<size_t> open; // scopes begun and not ended yet
+		uint64_t number = 0;
+		bool pending = false; // ended, its queries not read yet
+	};
+
+	std::vector<Frame> m_Frames;
+	size_t m_Current;
+	uint64_t m_FrameNumber;
+	bool m_InFrame;
+	bool m_TimerQueries, m_DebugGroups;
+	GpuFrameReport m_LastReport;
+	size_t m_SkippedFrames;
+	std::vector<uint64_t> m_Timestamps; // resolve() reads into it, kept so that reading a frame doesn't allocate
+public:
+	explicit GpuProfiler(unsigned int frameLatency = 4);
+	~GpuProfiler();
+
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	/* reads back the oldest frame if the gpu is done with it, then starts the "Frame" scope */
+	void beginFrame();
+	void endFrame();
+
+	/* name must outlive the profiler, string literals do */
+	void beginScope(const char* name);
+	void endScope();
+
+	/* the newest frame that was read back, frameLatency frames old */
+	inline const GpuFrameReport& getLastReport() const { return m_LastReport; }
+	inline size_t getSkippedFrames() const { return m_SkippedFrames; }
+	inline bool hasTimerQueries() const { return m_TimerQueries; }
+	void printReport() const;
+
+private:
+	unsigned int allocateQuery(Frame& frame);
+	void resolve(Frame& frame);
+};
+
+/* a scope for the lifetime of the object, nothing when profiler is nullptr */
+class GpuScope
+{
+private:
+	GpuProfiler* m_Profiler;
+public:
+	GpuScope(GpuProfiler* profiler, const char* name)
+		: m_Profiler(profiler)
+	{
+		if(m_Profiler)
+			m_Profiler->beginScope(name);
+	}
+
+	~GpuScope()
+	{
+		if(m_Profiler)
+			m_Profiler->endScope();
+	}
+
+	GpuScope(const GpuScope&) = delete;
+	GpuScope& operator=(const GpuScope&) = delete;
+};
+
+
+#endif //OPENGL_THECHERNO_GPUPROFILER_H
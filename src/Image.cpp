@@ -0,0 +1,178 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "Image.h"
+#include "vendor/stb_image/stb_image.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+size_t getPixelSize(PixelFormat format)
+{
+	switch(format)
+	{
+		case PixelFormat::R8:		return 1;
+		case PixelFormat::RG8:		return 2;
+		case PixelFormat::RGB8:		return 3;
+		case PixelFormat::RGBA8:	return 4;
+		case PixelFormat::R16F:		return sizeof(float);
+		case PixelFormat::RGBA16F:	return 4 * sizeof(float);
+		case PixelFormat::R32F:		return sizeof(float);
+	}
+	return 4;
+}
+
+unsigned int getChannelCount(PixelFormat format)
+{
+	switch(format)
+	{
+		case PixelFormat::R8:
+		case PixelFormat::R16F:
+		case PixelFormat::R32F:
+			return 1;
+		case PixelFormat::RG8:		return 2;
+		case PixelFormat::RGB8:		return 3;
+		case PixelFormat::RGBA8:
+		case PixelFormat::RGBA16F:
+			return 4;
+	}
+	return 4;
+}
+
+Image::Image()
+	: m_Width(0), m_Height(0), m_Channels(0), m_Format(PixelFormat::RGBA8), m_Pixels(nullptr)
+{
+}
+
+Image::Image(const std::string& filePath, bool keepChannels)
+	: m_Width(0), m_Height(0), m_Channels(0), m_Format(PixelFormat::RGBA8), m_Pixels(nullptr)
+{
+	/* OpenGL's coordinates start from bottom left. As our texture stores data from top, we need to flip it.
+	 * The _thread version only affects this thread, so decoding on several threads at once is fine */
+	stbi_set_flip_vertically_on_load_thread(1);
+
+	if(!keepChannels)
+	{
+		/* Gets the texture data to our local buffer*/
+		m_Pixels = stbi_load(filePath.c_str(), &m_Width, &m_Height, &m_Channels, 4);
+		return;
+	}
+
+	if(stbi_is_hdr(filePath.c_str()))
+	{
+		/* there's no RGB16F, three channels get an alpha of 1 */
+		int channels = 0;
+		if(!stbi_info(filePath.c_str(), &m_Width, &m_Height, &channels))
+			return;
+		m_Format = channels == 1 ? PixelFormat::R16F : PixelFormat::RGBA16F;
+		m_Pixels = reinterpret_cast<unsigned char*>(stbi_loadf(filePath.c_str(), &m_Width, &m_Height, &m_Channels,
+				static_cast<int>(getChannelCount(m_Format))));
+		return;
+	}
+
+	m_Pixels = stbi_load(filePath.c_str(), &m_Width, &m_Height, &m_Channels, 0);
+	const PixelFormat formats[] = {PixelFormat::R8, PixelFormat::RG8, PixelFormat::RGB8, PixelFormat::RGBA8};
+	if(m_Pixels)
+		m_Format = formats[m_Channels - 1];
+}
+
+Image::Image(int width, int height, PixelFormat format)
+	: m_Width(width), m_Height(height), m_Channels(static_cast<int>(getChannelCount(format))), m_Format(format),
+	m_Pixels(static_cast<unsigned char*>(std::malloc(static_cast<size_t>(width) * height * getPixelSize(format))))
+{
+}
+
+Image::~Image()
+{
+	// stb_image allocates with malloc, so this frees our own buffers just as well
+	if(m_Pixels)
+		stbi_image_free(m_Pixels);
+}
+
+Image::Image(Image&& other) noexcept
+	: m_Width(other.m_Width), m_Height(other.m_Height), m_Channels(other.m_Channels), m_Format(other.m_Format),
+	m_Pixels(other.m_Pixels)
+{
+	other.m_Pixels = nullptr;
+}
+
+Image& Image::operator=(Image&& other) noexcept
+{
+	std::swap(m_Width, other.m_Width);
+	std::swap(m_Height, other.m_Height);
+	std::swap(m_Channels, other.m_Channels);
+	std::swap(m_Format, other.m_Format);
+	std::swap(m_Pixels, other.m_Pixels);
+	return *this;
+}
+
+bool Image::hasAlpha() const
+{
+	switch(m_Format)
+	{
+		case PixelFormat::RG8:
+		case PixelFormat::RGBA8:
+		{
+			const size_t pixelSize = getPixelSize(m_Format);
+			for(size_t i = pixelSize - 1; i < getSize(); i += pixelSize)
+			{
+				if(m_Pixels[i] != 255)
+					return true;
+			}
+			return false;
+		}
+		case PixelFormat::RGBA16F:
+		{
+			const float* pixels = reinterpret_cast<const float*>(m_Pixels);
+			for(size_t i = 3; i < getSize() / sizeof(float); i += 4)
+			{
+				if(pixels[i] != 1.0f)
+					return true;
+			}
+			return false;
+		}
+		default:
+			return false;
+	}
+}
+
+bool Image::saveTga(const std::string& filePath) const
+{
+	if(!isValid() || m_Format != PixelFormat::RGBA8)
+	{
+		std::cout << "Image: only RGBA8 images can be saved, not '" << filePath << "'" << std::endl;
+		return false;
+	}
+	std::ofstream file(filePath, std::ios::binary);
+	if(!file)
+	{
+		std::cout << "Image: can't write '" << filePath << "'" << std::endl;
+		return false;
+	}
+
+	/* Uncompressed true color (type 2), 32 bits a pixel with 8 of them alpha. Our rows are bottom up like
+	 * opengl's, which is the order TGA stores them in when bit 5 of the descriptor is clear */
+	const unsigned char header[18] = {0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			static_cast<unsigned char>(m_Width & 0xff), static_cast<unsigned char>(m_Width >> 8),
+			static_cast<unsigned char>(m_Height & 0xff), static_cast<unsigned char>(m_Height >> 8), 32, 8};
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+	// TGA is BGRA
+	std::vector<unsigned char> row(getRowSize());
+	for(int y = 0; y < m_Height; y++)
+	{
+		const unsigned char* pixels = m_Pixels + y * getRowSize();
+		for(size_t i = 0; i < row.size(); i += 4)
+		{
+			row[i] = pixels[i + 2];
+			row[i + 1] = pixels[i + 1];
+			row[i + 2] = pixels[i];
+			row[i + 3] = pixels[i + 3];
+		}
+		file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+	}
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,70 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_IMAGE_H
+#define OPENGL_THECHERNO_IMAGE_H
+
+#include <cstddef>
+#include <string>
+
+/* How the pixels of an image are laid out. The 8 bit ones are what image files have: 1 channel is grey,
+ * 2 are grey and alpha. The 16F ones hold floats like R32F, the texture stores them as half floats */
+enum class PixelFormat
+{
+	R8,
+	RG8,
+	RGB8,
+	RGBA8,
+	R16F,
+	RGBA16F,
+	R32F
+};
+
+/* bytes a pixel of the format takes in system memory */
+size_t getPixelSize(PixelFormat format);
+unsigned int getChannelCount(PixelFormat format);
+
+/* Decoded pixels in system memory, bottom row first like opengl wants them, rows tightly packed.
+ * RGBA8 unless asked otherwise: that's what the mip generation, the block compressor and the atlas work on.
+ * Decoding doesn't touch opengl, so images can be made on any thread */
+class Image
+{
+private:
+	int m_Width, m_Height;
+	int m_Channels; // how many channels the file had
+	PixelFormat m_Format;
+	unsigned char* m_Pixels; // malloc'd (by stb_image or by us), freed with stbi_image_free
+public:
+	Image();
+	/* With keepChannels the pixels have the channels the file has (R8 to RGBA8), and .hdr files
+	 * load as R16F or RGBA16F. Otherwise the pixels are always RGBA8 */
+	explicit Image(const std::string& filePath, bool keepChannels = false);
+	Image(int width, int height, PixelFormat format = PixelFormat::RGBA8);
+	~Image();
+
+	Image(Image&& other) noexcept;
+	Image& operator=(Image&& other) noexcept;
+	Image(const Image&) = delete;
+	Image& operator=(const Image&) = delete;
+
+	inline bool isValid() const { return m_Pixels != nullptr; }
+	inline int getWidth() const { return m_Width; }
+	inline int getHeight() const { return m_Height; }
+	inline int getChannels() const { return m_Channels; }
+	inline PixelFormat getFormat() const { return m_Format; }
+	inline unsigned char* getPixels() { return m_Pixels; }
+	inline const unsigned char* getPixels() const { return m_Pixels; }
+	inline size_t getRowSize() const { return static_cast<size_t>(m_Width) * getPixelSize(m_Format); }
+	inline size_t getSize() const { return getRowSize() * m_Height; }
+
+	/* true when any pixel is not fully opaque */
+	bool hasAlpha() const;
+
+	/* Writes an uncompressed 32 bit TGA, which stb_image reads back as the same image. Only RGBA8, false
+	 * for anything else or when the file can't be written */
+	bool saveTga(const std::string& filePath) const;
+};
+
+
+#endif //OPENGL_THECHERNO_IMAGE_H
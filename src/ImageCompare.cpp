@@ -0,0 +1,59 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "ImageCompare.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+ImageDifference compareImages(const Image& expected, const Image& actual, int tolerance, Image* diff)
+{
+	ImageDifference difference = {false, 0, 0, 0.0};
+	if(expected.getFormat() != PixelFormat::RGBA8 || actual.getFormat() != PixelFormat::RGBA8)
+	{
+		std::cout << "compareImages: only RGBA8 images can be compared" << std::endl;
+		return difference;
+	}
+	if(expected.getWidth() != actual.getWidth() || expected.getHeight() != actual.getHeight())
+		return difference;
+	difference.sizeMatches = true;
+
+	const size_t pixelCount = static_cast<size_t>(expected.getWidth()) * expected.getHeight();
+	if(diff)
+		*diff = Image(expected.getWidth(), expected.getHeight());
+
+	const unsigned char* a = expected.getPixels();
+	const unsigned char* b = actual.getPixels();
+	uint64_t deltaSum = 0;
+	for(size_t i = 0; i < pixelCount; i++, a += 4, b += 4)
+	{
+		int delta = 0;
+		for(int c = 0; c < 4; c++)
+			delta = std::max(delta, std::abs(a[c] - b[c]));
+		deltaSum += delta;
+		difference.maxDelta = std::max(difference.maxDelta, delta);
+		if(delta > tolerance)
+			difference.differentPixels++;
+
+		if(diff)
+		{
+			unsigned char* out = diff->getPixels() + i * 4;
+			if(delta > tolerance)
+			{
+				// even a small difference should stand out, so it starts at half bright
+				out[0] = static_cast<unsigned char>(128 + delta / 2);
+				out[1] = 0;
+				out[2] = 0;
+			}
+			else
+			{
+				const auto grey = static_cast<unsigned char>((a[0] * 77 + a[1] * 150 + a[2] * 29) >> 10);
+				out[0] = out[1] = out[2] = grey;
+			}
+			out[3] = 255;
+		}
+	}
+	difference.meanDelta = pixelCount ? static_cast<double>(deltaSum) / static_cast<double>(pixelCount) : 0.0;
+	return difference;
+}
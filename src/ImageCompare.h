@@ -0,0 +1,28 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_IMAGECOMPARE_H
+#define OPENGL_THECHERNO_IMAGECOMPARE_H
+
+#include <cstdint>
+#include "Image.h"
+
+struct ImageDifference
+{
+	bool sizeMatches;
+	uint64_t differentPixels; // pixels with a channel further off than the tolerance
+	int maxDelta; // the largest difference of any channel, 0-255
+	double meanDelta; // the largest channel difference of a pixel, averaged over every pixel
+};
+
+/* Compares two RGBA8 images channel by channel. A pixel counts as different when one of its channels
+ * is more than tolerance away, so a driver rounding or dithering a little differently isn't a failure and
+ * a triangle missing is.
+ *
+ * With diff, it's given an image of the same size: the expected image in dimmed grey, with the pixels that
+ * differ in red, brighter the further off they are */
+ImageDifference compareImages(const Image& expected, const Image& actual, int tolerance, Image* diff = nullptr);
+
+
+#endif //OPENGL_THECHERNO_IMAGECOMPARE_H
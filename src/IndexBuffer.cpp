@@ -4,8 +4,11 @@
 
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "RenderStats.h"
+#include "GLObjectRegistry.h"
+#include <utility>
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count, std::source_location location)
 	: m_Count(count)
 {
     ASSERT(sizeof(unsigned int) == sizeof(GLuint));
@@ -17,13 +20,29 @@ IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
     // my index buffer is of element array type, size is 6 unsigned ints,
     // pointer to my indices array, and hint is draw static
     glCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+	RenderStats::current().bufferBytes += count * sizeof(unsigned int);
+	GLObjectRegistry::add(GLObjectType::IndexBuffer, m_Renderer_ID, count * sizeof(unsigned int), location);
 }
 
 IndexBuffer::~IndexBuffer()
 {
+	GLObjectRegistry::remove(GLObjectType::IndexBuffer, m_Renderer_ID);
 	glCall(glDeleteBuffers(1, &m_Renderer_ID));
 }
 
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+	: m_Renderer_ID(std::exchange(other.m_Renderer_ID, 0)), m_Count(std::exchange(other.m_Count, 0))
+{
+}
+
+/* the other one takes our buffer along and deletes it */
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+	std::swap(m_Renderer_ID, other.m_Renderer_ID);
+	std::swap(m_Count, other.m_Count);
+	return *this;
+}
+
 void IndexBuffer::bind() const
 {
 	glCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_Renderer_ID));
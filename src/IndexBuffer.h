@@ -5,16 +5,23 @@
 #ifndef OPENGL_THECHERNO_INDEXBUFFER_H
 #define OPENGL_THECHERNO_INDEXBUFFER_H
 
+#include <source_location>
 
+/* Owns its opengl buffer: it can be moved but not copied, a copy would delete the buffer twice */
 class IndexBuffer
 {
 private:
     unsigned int m_Renderer_ID;
     unsigned int m_Count; // number of indices the index buffer has
 public:
-    IndexBuffer(const unsigned int* data, unsigned int count);
+    IndexBuffer(const unsigned int* data, unsigned int count, std::source_location location = std::source_location::current());
     ~IndexBuffer();
 
+    IndexBuffer(const IndexBuffer&) = delete;
+    IndexBuffer& operator=(const IndexBuffer&) = delete;
+    IndexBuffer(IndexBuffer&& other) noexcept;
+    IndexBuffer& operator=(IndexBuffer&& other) noexcept;
+
     void bind() const;
     void unBind() const;
 
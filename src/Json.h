@@ -0,0 +1,33 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_JSON_H
+#define OPENGL_THECHERNO_JSON_H
+
+#include <cstdio>
+#include <ostream>
+#include <string_view>
+
+/* Writes text as a quoted JSON string, for the few JSON files we write by hand (traces, benchmark results) */
+inline void writeJsonString(std::ostream& out, std::string_view text)
+{
+	out << '"';
+	for(char c : text)
+	{
+		if(c == '"' || c == '\\')
+			out << '\\' << c;
+		else if(static_cast<unsigned char>(c) < 0x20)
+		{
+			char escaped[8];
+			std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			out << escaped;
+		}
+		else
+			out << c;
+	}
+	out << '"';
+}
+
+
+#endif //OPENGL_THECHERNO_JSON_H
@@ -0,0 +1,195 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "Material.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "TextureArray.h"
+#include <cstring>
+
+// uploads bind on Texture::EditSlot, which must stay out of the way of the slots bound here
+static_assert(MaterialBindState::MaxTextureSlots <= Texture::EditSlot);
+
+static unsigned int s_NextMaterialID = 1;
+static uint64_t s_BindGeneration = 1;
+
+void MaterialBindState::forgetAll()
+{
+	s_BindGeneration++;
+}
+
+uint64_t MaterialBindState::getGeneration()
+{
+	return s_BindGeneration;
+}
+
+Material::Material(Shader& shader)
+	: m_ID(s_NextMaterialID++), m_Shader(shader), m_Program(shader.getRendererID()), m_Textures{}, m_TextureArrays{},
+	m_Dirty(true)
+{
+}
+
+void Material::setTexture(UniformRef sampler, unsigned int slot, const Texture& texture)
+{
+	ASSERT(slot < MaxTextureSlots);
+	m_Textures[slot] = &texture;
+	m_TextureArrays[slot] = nullptr;
+	setUniform1i(sampler, static_cast<int>(slot));
+}
+
+void Material::setTexture(UniformRef sampler, unsigned int slot, const TextureArray& textureArray)
+{
+	ASSERT(slot < MaxTextureSlots);
+	m_TextureArrays[slot] = &textureArray;
+	m_Textures[slot] = nullptr;
+	setUniform1i(sampler, static_cast<int>(slot));
+}
+
+void Material::setUniform1f(UniformRef uniform, float v0)
+{
+	setUniform(uniform, GL_FLOAT, &v0, 1);
+}
+
+void Material::setUniform2f(UniformRef uniform, float v0, float v1)
+{
+	const float values[] = {v0, v1};
+	setUniform(uniform, GL_FLOAT_VEC2, values, 1);
+}
+
+void Material::setUniform3f(UniformRef uniform, float v0, float v1, float v2)
+{
+	const float values[] = {v0, v1, v2};
+	setUniform(uniform, GL_FLOAT_VEC3, values, 1);
+}
+
+void Material::setUniform4f(UniformRef uniform, float v0, float v1, float v2, float v3)
+{
+	const float values[] = {v0, v1, v2, v3};
+	setUniform(uniform, GL_FLOAT_VEC4, values, 1);
+}
+
+void Material::setUniform1i(UniformRef uniform, int v0)
+{
+	setUniform(uniform, GL_INT, &v0, 1);
+}
+
+void Material::setUniformMat3f(UniformRef uniform, const float* matrix)
+{
+	setUniform(uniform, GL_FLOAT_MAT3, matrix, 1);
+}
+
+void Material::setUniformMat4f(UniformRef uniform, const float* matrix)
+{
+	setUniform(uniform, GL_FLOAT_MAT4, matrix, 1);
+}
+
+void Material::setUniform(const UniformRef& uniform, unsigned int type, const void* data, int count)
+{
+	resolveUniforms();
+	UniformHandle handle = uniform.handle.isValid() || uniform.name.name.empty()
+		? uniform.handle : m_Shader.getUniformHandle(uniform.name);
+	if(!handle.isValid())
+		return; // the shader already warned about it
+
+	unsigned int size = getUniformTypeInfo(type).components * sizeof(uint32_t) * count;
+	for(UniformValue& value : m_Uniforms)
+	{
+		if(value.handle.index != handle.index)
+			continue;
+
+		unsigned char* bytes = reinterpret_cast<unsigned char*>(m_Values.data()) + value.offset;
+		if(value.type == type && value.size == size)
+		{
+			if(std::memcmp(bytes, data, size) != 0)
+			{
+				std::memcpy(bytes, data, size);
+				m_Dirty = true;
+			}
+			return;
+		}
+		// same uniform with a different type or count, forget the old value and store it again below
+		value.handle = {};
+	}
+
+	unsigned int offset = m_Values.size() * sizeof(uint32_t);
+	m_Values.resize(m_Values.size() + size / sizeof(uint32_t));
+	std::memcpy(reinterpret_cast<unsigned char*>(m_Values.data()) + offset, data, size);
+	m_Uniforms.push_back({handle, type, count, offset, size, m_Shader.getUniformInfo(handle).name});
+	m_Dirty = true;
+}
+
+void Material::resolveUniforms() const
+{
+	if(m_Program == m_Shader.getRendererID())
+		return;
+
+	for(UniformValue& value : m_Uniforms)
+	{
+		// the ones that were forgotten stay forgotten
+		if(value.handle.isValid())
+			value.handle = m_Shader.getUniformHandle(value.name);
+	}
+	m_Program = m_Shader.getRendererID();
+	m_Dirty = true;
+}
+
+void Material::bind(MaterialBindState& state) const
+{
+	if(state.generation != s_BindGeneration)
+	{
+		state = MaterialBindState();
+		state.generation = s_BindGeneration;
+	}
+	resolveUniforms();
+
+	if(state.program != m_Shader.getRendererID())
+	{
+		m_Shader.bind();
+		state.program = m_Shader.getRendererID();
+	}
+
+	for(unsigned int slot = 0; slot < MaxTextureSlots; slot++)
+	{
+		const Texture* texture = m_Textures[slot];
+		if(texture && state.textures[slot] != texture->getRendererID())
+		{
+			texture->bind(slot);
+			state.textures[slot] = texture->getRendererID();
+		}
+		// names are unique whatever the target, so the same check works for arrays
+		const TextureArray* textureArray = m_TextureArrays[slot];
+		if(textureArray && state.textures[slot] != textureArray->getRendererID())
+		{
+			textureArray->bind(slot);
+			state.textures[slot] = textureArray->getRendererID();
+		}
+	}
+
+	/* The shader keeps its own copy of the uniforms and ignores values it already has,
+	 * so even when the previous material used the same shader only the uniforms that differ get uploaded */
+	if(state.material != m_ID || m_Dirty)
+	{
+		for(const UniformValue& value : m_Uniforms)
+		{
+			if(value.handle.isValid())
+				m_Shader.setUniform(value.handle, value.type,
+						reinterpret_cast<const unsigned char*>(m_Values.data()) + value.offset, value.count);
+		}
+		m_Dirty = false;
+		state.material = m_ID;
+	}
+	m_Shader.uploadUniforms();
+}
+
+void Material::bind() const
+{
+	MaterialBindState state;
+	bind(state);
+}
+
+uint64_t Material::getSortKey() const
+{
+	return static_cast<uint64_t>(m_Shader.getRendererID()) << 32 | m_ID;
+}
@@ -0,0 +1,111 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_MATERIAL_H
+#define OPENGL_THECHERNO_MATERIAL_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "UniformTable.h"
+
+class Shader;
+class Texture;
+class TextureArray;
+
+/* What was last bound through a material. The renderer keeps one of these between draws */
+struct MaterialBindState
+{
+	static constexpr unsigned int MaxTextureSlots = 16;
+
+	// opengl names and not Shader or Texture pointers, a texture that is still loading binds its placeholder
+	unsigned int program = 0;
+	std::array<unsigned int, MaxTextureSlots> textures{};
+	// the id and not the address, a material moved in a vector can leave another one at its old address
+	unsigned int material = 0;
+	// the states made before the last forgetAll() are treated as empty
+	uint64_t generation = 0;
+
+	/* Opengl hands a deleted name out again, so a program or texture made after one was deleted can have
+	 * the name a state still thinks is bound, when the unit was actually reset to 0. The wrappers call
+	 * this whenever they delete a name, and every state starts over at its next bind */
+	static void forgetAll();
+	static uint64_t getGeneration();
+};
+
+/* Everything a draw needs besides the geometry: the shader, the textures in their slots
+ * and the values of the shader's uniforms. Several materials can share one shader */
+class Material
+{
+public:
+	static constexpr unsigned int MaxTextureSlots = MaterialBindState::MaxTextureSlots;
+private:
+	struct UniformValue
+	{
+		UniformHandle handle;
+		unsigned int type;
+		int count;
+		unsigned int offset; // into m_Values, in bytes
+		unsigned int size; // in bytes
+		std::string name; // to find the uniform again when the shader's program changes
+	};
+
+	unsigned int m_ID;
+	Shader& m_Shader;
+	// the program m_Uniforms' handles were resolved in
+	mutable unsigned int m_Program;
+	std::array<const Texture*, MaxTextureSlots> m_Textures;
+	std::array<const TextureArray*, MaxTextureSlots> m_TextureArrays; // a slot has one or the other
+	mutable std::vector<UniformValue> m_Uniforms;
+	std::vector<uint32_t> m_Values;
+	// set when a uniform changes, so that binding the same material again re-applies its values
+	mutable bool m_Dirty;
+public:
+	explicit Material(Shader& shader);
+
+	/* the id is what sorts and binds the material, a copy with the same one would be taken for it.
+	 * So it moves, but doesn't copy */
+	Material(const Material&) = delete;
+	Material& operator=(const Material&) = delete;
+	Material(Material&& other) noexcept = default;
+
+	/* binds the texture to the slot, and points the sampler uniform at that slot */
+	void setTexture(UniformRef sampler, unsigned int slot, const Texture& texture);
+	/* the same for a sampler2DArray */
+	void setTexture(UniformRef sampler, unsigned int slot, const TextureArray& textureArray);
+
+	void setUniform1f(UniformRef uniform, float v0);
+	void setUniform2f(UniformRef uniform, float v0, float v1);
+	void setUniform3f(UniformRef uniform, float v0, float v1, float v2);
+	void setUniform4f(UniformRef uniform, float v0, float v1, float v2, float v3);
+	void setUniform1i(UniformRef uniform, int v0);
+	void setUniformMat3f(UniformRef uniform, const float* matrix);
+	void setUniformMat4f(UniformRef uniform, const float* matrix);
+	void setUniform(const UniformRef& uniform, unsigned int type, const void* data, int count);
+
+	/* Makes this material current. Only the shader, textures and uniforms that differ from
+	 * what the previously bound material left in state are applied, and state is updated */
+	void bind(MaterialBindState& state) const;
+	/* binds everything, for when we don't know what is currently bound */
+	void bind() const;
+
+	/* Stable id, given out in creation order. Never reused while the program runs */
+	inline unsigned int getID() const { return m_ID; }
+	/* Render queues sort by this: draws that share a shader end up next to each other,
+	 * and within a shader draws of the same material are grouped */
+	uint64_t getSortKey() const;
+
+	inline Shader& getShader() const { return m_Shader; }
+	inline const Texture* getTexture(unsigned int slot) const { return m_Textures[slot]; }
+	inline const TextureArray* getTextureArray(unsigned int slot) const { return m_TextureArrays[slot]; }
+
+private:
+	/* a shader that was moved into (reloaded, say) has another program, where the handles can point
+	 * at other uniforms. Looks them up again by name */
+	void resolveUniforms() const;
+};
+
+
+#endif //OPENGL_THECHERNO_MATERIAL_H
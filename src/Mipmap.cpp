@@ -0,0 +1,170 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "Mipmap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <emmintrin.h>
+
+namespace
+{
+	/* sRGB to linear for every byte, and back from 12 bits of linear, which is enough to land on the
+	 * right byte everywhere but in the darkest few values */
+	struct GammaTables
+	{
+		float toLinear[256];
+		unsigned char toSRGB[4096];
+
+		GammaTables()
+		{
+			for(int i = 0; i < 256; i++)
+			{
+				float c = static_cast<float>(i) / 255.0f;
+				toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			for(int i = 0; i < 4096; i++)
+			{
+				float l = static_cast<float>(i) / 4095.0f;
+				float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+				toSRGB[i] = static_cast<unsigned char>(std::clamp(static_cast<int>(c * 255.0f + 0.5f), 0, 255));
+			}
+		}
+	};
+
+	const GammaTables& getGammaTables()
+	{
+		static const GammaTables tables;
+		return tables;
+	}
+
+	/* the rows and columns of the source that output row/column i averages, the last ones repeat when the size is odd */
+	inline int sourceIndex(int i, int offset, int size) { return std::min(i * 2 + offset, size - 1); }
+
+	void downsampleRows(const Image& image, Image& half, int firstRow, int endRow)
+	{
+		const int width = image.getWidth(), height = image.getHeight();
+		const size_t stride = static_cast<size_t>(width) * 4;
+		const __m128i zero = _mm_setzero_si128(), two = _mm_set1_epi16(2);
+
+		for(int y = firstRow; y < endRow; y++)
+		{
+			const unsigned char* row0 = image.getPixels() + sourceIndex(y, 0, height) * stride;
+			const unsigned char* row1 = image.getPixels() + sourceIndex(y, 1, height) * stride;
+			unsigned char* target = half.getPixels() + static_cast<size_t>(y) * half.getWidth() * 4;
+
+			int x = 0;
+			// 8 source pixels of each row make 4 output pixels
+			for(; x * 2 + 8 <= width; x += 4)
+			{
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8 + 16));
+				__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+				__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8 + 16));
+
+				// 16 bits per channel, 2 pixels per register, the two rows added
+				__m128i s01 = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(c, zero));
+				__m128i s23 = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(c, zero));
+				__m128i s45 = _mm_add_epi16(_mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(d, zero));
+				__m128i s67 = _mm_add_epi16(_mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(d, zero));
+
+				// then the neighbouring columns, rounded
+				__m128i o01 = _mm_add_epi16(_mm_unpacklo_epi64(s01, s23), _mm_unpackhi_epi64(s01, s23));
+				__m128i o23 = _mm_add_epi16(_mm_unpacklo_epi64(s45, s67), _mm_unpackhi_epi64(s45, s67));
+				o01 = _mm_srli_epi16(_mm_add_epi16(o01, two), 2);
+				o23 = _mm_srli_epi16(_mm_add_epi16(o23, two), 2);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(target + x * 4), _mm_packus_epi16(o01, o23));
+			}
+			for(; x < half.getWidth(); x++)
+			{
+				const int x0 = sourceIndex(x, 0, width) * 4, x1 = sourceIndex(x, 1, width) * 4;
+				for(int c = 0; c < 4; c++)
+					target[x * 4 + c] = static_cast<unsigned char>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+			}
+		}
+	}
+
+	void downsampleRowsGammaCorrect(const Image& image, Image& half, int firstRow, int endRow)
+	{
+		const GammaTables& tables = getGammaTables();
+		const int width = image.getWidth(), height = image.getHeight();
+		const size_t stride = static_cast<size_t>(width) * 4;
+
+		auto toLinear = [&tables](const unsigned char* pixel) {
+			return _mm_setr_ps(tables.toLinear[pixel[0]], tables.toLinear[pixel[1]], tables.toLinear[pixel[2]], pixel[3] / 255.0f);
+		};
+		// a quarter for the average, and the scale to the table index (color) or the byte (alpha)
+		const __m128 scale = _mm_setr_ps(4095.0f / 4.0f, 4095.0f / 4.0f, 4095.0f / 4.0f, 255.0f / 4.0f);
+		const __m128 rounding = _mm_set1_ps(0.5f);
+
+		for(int y = firstRow; y < endRow; y++)
+		{
+			const unsigned char* row0 = image.getPixels() + sourceIndex(y, 0, height) * stride;
+			const unsigned char* row1 = image.getPixels() + sourceIndex(y, 1, height) * stride;
+			unsigned char* target = half.getPixels() + static_cast<size_t>(y) * half.getWidth() * 4;
+
+			for(int x = 0; x < half.getWidth(); x++)
+			{
+				const int x0 = sourceIndex(x, 0, width) * 4, x1 = sourceIndex(x, 1, width) * 4;
+				__m128 sum = _mm_add_ps(_mm_add_ps(toLinear(row0 + x0), toLinear(row0 + x1)),
+						_mm_add_ps(toLinear(row1 + x0), toLinear(row1 + x1)));
+
+				alignas(16) int32_t values[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(values), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(sum, scale), rounding)));
+				target[x * 4] = tables.toSRGB[values[0]];
+				target[x * 4 + 1] = tables.toSRGB[values[1]];
+				target[x * 4 + 2] = tables.toSRGB[values[2]];
+				target[x * 4 + 3] = static_cast<unsigned char>(values[3]);
+			}
+		}
+	}
+}
+
+unsigned int getMipLevelCount(int width, int height)
+{
+	unsigned int levels = 1;
+	for(int size = std::max(width, height); size > 1; size /= 2)
+		levels++;
+	return levels;
+}
+
+Image downsample(const Image& image, bool gammaCorrect, unsigned int threadCount)
+{
+	if(!image.isValid() || image.getFormat() != PixelFormat::RGBA8)
+		return {};
+
+	Image half(std::max(1, image.getWidth() / 2), std::max(1, image.getHeight() / 2));
+	auto work = gammaCorrect ? downsampleRowsGammaCorrect : downsampleRows;
+
+	/* small levels aren't worth a thread */
+	const int rows = half.getHeight();
+	threadCount = std::clamp(threadCount, 1u, static_cast<unsigned int>(std::max(1, rows / 16)));
+	const int rowsPerThread = (rows + static_cast<int>(threadCount) - 1) / static_cast<int>(threadCount);
+
+	std::vector<std::thread> threads;
+	for(unsigned int i = 1; i < threadCount; i++)
+	{
+		int first = static_cast<int>(i) * rowsPerThread;
+		if(first < rows)
+			threads.emplace_back(work, std::cref(image), std::ref(half), first, std::min(rows, first + rowsPerThread));
+	}
+	work(image, half, 0, std::min(rows, rowsPerThread));
+	for(std::thread& thread : threads)
+		thread.join();
+	return half;
+}
+
+std::vector<Image> generateMipChain(const Image& image, bool gammaCorrect, unsigned int threadCount)
+{
+	std::vector<Image> levels;
+	levels.reserve(getMipLevelCount(image.getWidth(), image.getHeight()) - 1);
+	const Image* level = &image;
+	while(level->isValid() && (level->getWidth() > 1 || level->getHeight() > 1))
+	{
+		levels.push_back(downsample(*level, gammaCorrect, threadCount));
+		level = &levels.back();
+	}
+	return levels;
+}
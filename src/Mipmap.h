@@ -0,0 +1,32 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_MIPMAP_H
+#define OPENGL_THECHERNO_MIPMAP_H
+
+#include <vector>
+#include "Image.h"
+
+/* CPU mip generation, for when glGenerateMipmap can't be used (block compressed textures, offline tools)
+ * or isn't good enough.
+ *
+ * Each level is half the size of the one above, rounded down but at least 1, and every pixel is the
+ * average of the 2x2 pixels it covers. Gamma correct means the colors are averaged as light, not as
+ * sRGB numbers: a black and white checkerboard becomes the grey of 188, not 128. Without it the smaller
+ * levels come out darker, which glGenerateMipmap does for GL_RGBA8 textures. Alpha is always averaged
+ * as it is.
+ *
+ * Both ways run on SSE2. threadCount splits the rows of each level between that many threads,
+ * the calling thread included. Leave it at 1 on threads that are already part of a pool.
+ * Only RGBA8 images are downsampled, any other format gives an invalid image */
+
+/* how many levels a full chain has, the full size one included */
+unsigned int getMipLevelCount(int width, int height);
+
+Image downsample(const Image& image, bool gammaCorrect = true, unsigned int threadCount = 1);
+
+/* levels 1 to the 1x1 one, level 0 is the image itself */
+std::vector<Image> generateMipChain(const Image& image, bool gammaCorrect = true, unsigned int threadCount = 1);
+
+#endif //OPENGL_THECHERNO_MIPMAP_H
@@ -0,0 +1,152 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "PixelUploadRing.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include <algorithm>
+#include <cstring>
+
+PixelUploadRing::PixelUploadRing(unsigned int slotCount, size_t slotSize)
+	: m_SlotSize(slotSize), m_NextSlot(0), m_Persistent(GLEW_ARB_buffer_storage)
+{
+	const GLbitfield persistentFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	m_Slots.resize(slotCount);
+	for(Slot& slot : m_Slots)
+	{
+		slot.mapped = nullptr;
+		slot.fence = nullptr;
+		glCall(glGenBuffers(1, &slot.buffer));
+		glCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer));
+		if(m_Persistent)
+		{
+			/* immutable storage that stays mapped while the gpu reads from it. coherent means our writes
+			 * are visible to the gpu without flushing, the fence does the rest */
+			glCall(glBufferStorage(GL_PIXEL_UNPACK_BUFFER, m_SlotSize, nullptr, persistentFlags));
+			glCall(slot.mapped = static_cast<unsigned char*>(
+					glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_SlotSize, persistentFlags)));
+		}
+		else
+		{
+			glCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, m_SlotSize, nullptr, GL_STREAM_DRAW));
+		}
+	}
+	glCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+}
+
+PixelUploadRing::~PixelUploadRing()
+{
+	for(Slot& slot : m_Slots)
+	{
+		if(slot.fence)
+		{
+			glCall(glDeleteSync(slot.fence));
+		}
+		if(slot.mapped)
+		{
+			glCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer));
+			glCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+		}
+		glCall(glDeleteBuffers(1, &slot.buffer));
+	}
+	glCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+}
+
+void PixelUploadRing::upload(std::shared_ptr<Texture> texture, Image image, std::function<void()> onComplete)
+{
+	ASSERT(image.isValid());
+	texture->allocate(image.getWidth(), image.getHeight(), 0, image.getFormat());
+	m_Jobs.push_back({std::move(texture), std::move(image), 0, std::move(onComplete)});
+}
+
+void PixelUploadRing::cancel(const Texture& texture)
+{
+	std::erase_if(m_Jobs, [&texture](const Job& job) { return job.texture.get() == &texture; });
+}
+
+bool PixelUploadRing::acquire(Slot& slot)
+{
+	if(!slot.fence)
+		return true;
+
+	// a timeout of 0 only asks, it never waits
+	glCall(GLenum status = glClientWaitSync(slot.fence, 0, 0));
+	if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		return false;
+
+	glCall(glDeleteSync(slot.fence));
+	slot.fence = nullptr;
+	return true;
+}
+
+unsigned int PixelUploadRing::update(size_t byteBudget)
+{
+	unsigned int completed = 0;
+	size_t bytesLeft = byteBudget;
+
+	while(!m_Jobs.empty())
+	{
+		Job& job = m_Jobs.front();
+		const size_t rowSize = job.image.getRowSize();
+		const int rowsLeft = job.image.getHeight() - job.nextRow;
+
+		int rows = static_cast<int>(std::min({m_SlotSize / rowSize, bytesLeft / rowSize, static_cast<size_t>(rowsLeft)}));
+		if(rowSize > m_SlotSize)
+		{
+			/* a single row doesn't fit in a slot, so this one goes straight from client memory */
+			job.texture->uploadRows(0, job.image.getHeight(), job.image.getPixels());
+			rows = rowsLeft;
+			bytesLeft -= std::min(bytesLeft, rowSize * rows);
+		}
+		else
+		{
+			if(rows == 0 && byteBudget > 0 && bytesLeft == byteBudget)
+				rows = 1; // a row larger than the whole budget still goes in, alone, or it would never go
+			if(rows == 0)
+				break; // out of budget for this frame
+
+			Slot& slot = m_Slots[m_NextSlot];
+			if(!acquire(slot))
+				break; // the gpu is still reading the oldest slot, try again next frame
+
+			const unsigned char* source = job.image.getPixels() + rowSize * job.nextRow;
+			const size_t bytes = rowSize * rows;
+
+			glCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer));
+			if(slot.mapped)
+			{
+				std::memcpy(slot.mapped, source, bytes);
+			}
+			else
+			{
+				/* the fence said the gpu is done with the slot, so we don't need the driver to synchronise for us */
+				glCall(void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+						GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+				std::memcpy(mapped, source, bytes);
+				glCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+			}
+
+			// with the unpack buffer bound the last argument is an offset into it, so 0 here
+			job.texture->uploadRows(job.nextRow, rows, nullptr);
+			glCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+			glCall(slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+			m_NextSlot = (m_NextSlot + 1) % m_Slots.size();
+			bytesLeft -= std::min(bytesLeft, bytes);
+		}
+
+		job.nextRow += rows;
+		if(job.nextRow == job.image.getHeight())
+		{
+			job.texture->generateMipmaps();
+			job.texture->setReady();
+			if(job.onComplete)
+				job.onComplete();
+			m_Jobs.pop_front();
+			completed++;
+		}
+	}
+	return completed;
+}
@@ -0,0 +1,77 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_PIXELUPLOADRING_H
+#define OPENGL_THECHERNO_PIXELUPLOADRING_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Image.h"
+
+class Texture;
+typedef struct __GLsync* GLsync;
+
+/* Streams pixels to textures through a ring of pixel unpack buffers (PBOs).
+ *
+ * glTexImage2D from client memory makes the driver copy our pixels before it returns, and it may
+ * have to wait for the gpu to do so. Here we copy the rows into a buffer the driver already owns
+ * (mapped once and kept mapped, when ARB_buffer_storage is there), and glTexSubImage2D reads them
+ * from that buffer whenever the gpu gets to it. A fence after each upload tells us when the gpu
+ * is done with a slot so that we can write into it again. We never wait on a fence, a busy ring
+ * just means the rest of the upload happens next frame.
+ * */
+class PixelUploadRing
+{
+private:
+	struct Slot
+	{
+		unsigned int buffer;
+		unsigned char* mapped; // persistently mapped, nullptr when we have to map for every upload
+		GLsync fence; // nullptr when the gpu isn't using the slot
+	};
+
+	struct Job
+	{
+		std::shared_ptr<Texture> texture;
+		Image image;
+		int nextRow;
+		std::function<void()> onComplete;
+	};
+
+	std::vector<Slot> m_Slots;
+	size_t m_SlotSize;
+	unsigned int m_NextSlot;
+	bool m_Persistent;
+	std::deque<Job> m_Jobs;
+public:
+	explicit PixelUploadRing(unsigned int slotCount = 4, size_t slotSize = 4 * 1024 * 1024);
+	~PixelUploadRing();
+
+	PixelUploadRing(const PixelUploadRing&) = delete;
+	PixelUploadRing& operator=(const PixelUploadRing&) = delete;
+
+	/* Queues the image for the texture. The storage is allocated now, the rows follow in update().
+	 * onComplete is called (on the GL thread) once the last row was issued */
+	void upload(std::shared_ptr<Texture> texture, Image image, std::function<void()> onComplete = {});
+
+	/* Issues uploads of at most byteBudget bytes, splitting big textures into bands of rows. A row larger
+	 * than the budget goes alone. Returns how many textures were completed */
+	unsigned int update(size_t byteBudget);
+
+	/* Drops the texture's upload without calling its onComplete. The rows issued so far stay, the texture
+	 * is left not ready */
+	void cancel(const Texture& texture);
+
+	inline bool isIdle() const { return m_Jobs.empty(); }
+	inline bool isPersistent() const { return m_Persistent; }
+
+private:
+	bool acquire(Slot& slot);
+};
+
+
+#endif //OPENGL_THECHERNO_PIXELUPLOADRING_H
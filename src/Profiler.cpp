@@ -0,0 +1,198 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "Profiler.h"
+#include "Json.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_RDTSC
+#endif
+
+namespace
+{
+	struct Event
+	{
+		const char* name;
+		uint64_t start, end;
+		AllocationCounts allocations;
+	};
+
+	constexpr size_t ChunkSize = 16384; // events, 640 KB
+	constexpr size_t MaxChunks = 256;
+
+	/* Written by its thread only. The events up to count are complete: the thread writes an event and then
+	 * publishes it with a release store, so whoever reads count with acquire sees the whole event */
+	struct ThreadBuffer
+	{
+		std::atomic<Event*> chunks[MaxChunks] = {};
+		std::atomic<size_t> count{0};
+		std::atomic<size_t> dropped{0};
+		std::atomic<const char*> name{nullptr};
+		unsigned int id = 0;
+
+		~ThreadBuffer()
+		{
+			for(std::atomic<Event*>& chunk : chunks)
+				std::free(chunk.load());
+		}
+	};
+
+	struct Registry
+	{
+		std::mutex mutex; // only taken when a thread records for the first time, and to write the trace
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+		// the ticks and the clock at startup, writing the trace measures how many ticks make a microsecond
+		uint64_t startTicks = Profiler::now();
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	};
+
+	Registry& getRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	/* The registry owns the buffers, so they outlive their threads and worker threads that are already
+	 * gone still show up in the trace */
+	ThreadBuffer& getThreadBuffer()
+	{
+		thread_local ThreadBuffer* buffer = nullptr;
+		if(!buffer)
+		{
+			Registry& registry = getRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.buffers.push_back(std::make_unique<ThreadBuffer>());
+			buffer = registry.buffers.back().get();
+			buffer->id = static_cast<unsigned int>(registry.buffers.size());
+		}
+		return *buffer;
+	}
+}
+
+uint64_t Profiler::now()
+{
+#ifdef PROFILER_RDTSC
+	/* The counter of modern x86 cpus ticks at a constant rate whatever the clock speed, and reading
+	 * it is a few nanoseconds where a clock is tens */
+	return __rdtsc();
+#else
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+void Profiler::record(const char* name, uint64_t start, uint64_t end, AllocationCounts allocations)
+{
+	ThreadBuffer& buffer = getThreadBuffer();
+	const size_t index = buffer.count.load(std::memory_order_relaxed);
+	const size_t chunkIndex = index / ChunkSize;
+	if(chunkIndex >= MaxChunks)
+	{
+		buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Event* chunk = buffer.chunks[chunkIndex].load(std::memory_order_relaxed);
+	if(!chunk)
+	{
+		// malloc and not new, the allocation tracker shouldn't count the profiler's buffers against the frame
+		chunk = static_cast<Event*>(std::malloc(ChunkSize * sizeof(Event)));
+		buffer.chunks[chunkIndex].store(chunk, std::memory_order_release);
+	}
+	chunk[index % ChunkSize] = {name, start, end, allocations};
+	buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const char* name)
+{
+	getThreadBuffer().name.store(name, std::memory_order_release);
+}
+
+bool Profiler::writeChromeTrace(const std::string& filePath)
+{
+#ifndef PROFILER_ENABLED
+	std::cout << "Profiler: nothing was recorded, configure with -DENABLE_PROFILER=ON to get '" << filePath << "'" << std::endl;
+	return false;
+#else
+	std::ofstream file(filePath);
+	if(!file)
+	{
+		std::cout << "Profiler: can't write '" << filePath << "'" << std::endl;
+		return false;
+	}
+
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	const uint64_t ticks = now() - registry.startTicks;
+	const double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - registry.startTime).count();
+	const double ticksPerMicrosecond = microseconds > 0.0 && ticks > 0 ? static_cast<double>(ticks) / microseconds : 1000.0;
+
+	/* "X" events have a start and a duration, the viewer nests the ones of a thread by themselves */
+	file << std::fixed;
+	file.precision(3); // the times are in microseconds, to the nanosecond
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	size_t eventCount = 0;
+	for(const std::unique_ptr<ThreadBuffer>& buffer : registry.buffers)
+	{
+		if(const char* name = buffer->name.load(std::memory_order_acquire))
+		{
+			file << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":";
+			writeJsonString(file, name);
+			file << "}}";
+			first = false;
+		}
+
+		const size_t count = buffer->count.load(std::memory_order_acquire);
+		for(size_t i = 0; i < count; i++)
+		{
+			const Event& event = buffer->chunks[i / ChunkSize].load(std::memory_order_acquire)[i % ChunkSize];
+			const double start = static_cast<double>(static_cast<int64_t>(event.start - registry.startTicks)) / ticksPerMicrosecond;
+			const double duration = static_cast<double>(event.end - event.start) / ticksPerMicrosecond;
+			file << (first ? "" : ",\n") << "{\"ph\":\"X\",\"cat\":\"cpu\",\"name\":";
+			writeJsonString(file, event.name);
+			file << ",\"pid\":1,\"tid\":" << buffer->id << ",\"ts\":" << start << ",\"dur\":" << duration;
+			if(event.allocations.allocations > 0)
+				file << ",\"args\":{\"allocations\":" << event.allocations.allocations << ",\"bytes\":" << event.allocations.bytes << "}";
+			file << "}";
+			first = false;
+		}
+		eventCount += count;
+	}
+	file << "\n]}\n";
+
+	std::cout << "Profiler: wrote " << eventCount << " events to '" << filePath << "'" << std::endl;
+	return static_cast<bool>(file);
+#endif
+}
+
+size_t Profiler::getEventCount()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	size_t count = 0;
+	for(const std::unique_ptr<ThreadBuffer>& buffer : registry.buffers)
+		count += buffer->count.load(std::memory_order_acquire);
+	return count;
+}
+
+size_t Profiler::getDroppedCount()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	size_t count = 0;
+	for(const std::unique_ptr<ThreadBuffer>& buffer : registry.buffers)
+		count += buffer->dropped.load(std::memory_order_relaxed);
+	return count;
+}
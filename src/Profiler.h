@@ -0,0 +1,88 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_PROFILER_H
+#define OPENGL_THECHERNO_PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "AllocationTracker.h"
+
+/* Scoped CPU timings, written out as a Chrome trace_event JSON file (open it in Perfetto or chrome://tracing).
+ *
+ *     void Renderer::clear() const
+ *     {
+ *         PROFILE_SCOPE("Renderer::clear");
+ *         ...
+ *     }
+ *
+ * Every thread writes its events into its own buffer, so recording never takes a lock or waits on another
+ * thread: two reads of the time stamp counter and a store. The names must outlive the profiler, string
+ * literals do. The buffers grow in chunks up to a few million events per thread, what comes after that is
+ * counted but not kept.
+ *
+ * With the allocation tracker built in too, each event also has the heap allocations its thread made in it.
+ *
+ * Only built in with -DENABLE_PROFILER=ON (which defines PROFILER_ENABLED), otherwise the macros are empty
+ * and nothing of it is left in the code they're in */
+class Profiler
+{
+public:
+	/* the current time in ticks: the time stamp counter on x86, nanoseconds elsewhere */
+	static uint64_t now();
+	/* an event on the calling thread, start and end from now(), with what was allocated in it */
+	static void record(const char* name, uint64_t start, uint64_t end, AllocationCounts allocations = {});
+	/* what the calling thread is called in the trace */
+	static void setThreadName(const char* name);
+
+	/* Writes every event so far. Can be called while other threads record, their newest events may just
+	 * not make it in. false if the file can't be written or the profiler is compiled out */
+	static bool writeChromeTrace(const std::string& filePath);
+	static size_t getEventCount();
+	/* the events that didn't fit in the buffers */
+	static size_t getDroppedCount();
+};
+
+/* records from its construction to its destruction */
+class ProfileScope
+{
+private:
+	const char* m_Name;
+	uint64_t m_Start;
+	AllocationCounts m_Allocations;
+public:
+	explicit ProfileScope(const char* name)
+		: m_Name(name), m_Start(Profiler::now()), m_Allocations(AllocationTracker::isEnabled() ? AllocationTracker::getThreadCounts() : AllocationCounts{})
+	{
+	}
+
+	~ProfileScope()
+	{
+		AllocationCounts allocations = {};
+		if(AllocationTracker::isEnabled())
+		{
+			const AllocationCounts now = AllocationTracker::getThreadCounts();
+			allocations = {now.allocations - m_Allocations.allocations, now.bytes - m_Allocations.bytes};
+		}
+		Profiler::record(m_Name, m_Start, Profiler::now(), allocations);
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PROFILER_ENABLED
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_THREAD(name)
+#endif
+
+
+#endif //OPENGL_THECHERNO_PROFILER_H
@@ -0,0 +1,55 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "RenderStats.h"
+#include <fstream>
+#include <iostream>
+
+FrameStats RenderStats::s_Current = {};
+
+namespace
+{
+	FrameStats lastFrame = {};
+	std::ofstream csv;
+}
+
+void RenderStats::endFrame()
+{
+	lastFrame = s_Current;
+	if(csv.is_open())
+	{
+		const FrameStats& s = lastFrame;
+		csv << s.frame << ',' << s.drawCalls << ',' << s.indices << ',' << s.triangles << ',' << s.programBinds << ','
+			<< s.vertexArrayBinds << ',' << s.textureBinds << ',' << s.uniformUploads << ',' << s.bufferBytes << ','
+			<< s.textureBytes << '\n';
+	}
+
+	const uint64_t frame = s_Current.frame;
+	s_Current = {};
+	s_Current.frame = frame + 1;
+}
+
+const FrameStats& RenderStats::getLastFrame()
+{
+	return lastFrame;
+}
+
+bool RenderStats::openCsv(const std::string& filePath)
+{
+	csv.close();
+	csv.open(filePath);
+	if(!csv)
+	{
+		std::cout << "RenderStats: can't write '" << filePath << "'" << std::endl;
+		return false;
+	}
+	csv << "frame,draw_calls,indices,triangles,program_binds,vertex_array_binds,texture_binds,uniform_uploads,"
+		   "buffer_bytes,texture_bytes\n";
+	return true;
+}
+
+void RenderStats::closeCsv()
+{
+	csv.close();
+}
@@ -0,0 +1,46 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_RENDERSTATS_H
+#define OPENGL_THECHERNO_RENDERSTATS_H
+
+#include <cstdint>
+#include <string>
+
+/* what the renderer and the wrappers sent to opengl in a frame */
+struct FrameStats
+{
+	uint64_t frame;
+	uint64_t drawCalls;
+	uint64_t indices;
+	uint64_t triangles;
+	uint64_t programBinds;
+	uint64_t vertexArrayBinds;
+	uint64_t textureBinds;
+	uint64_t uniformUploads; // glUniform* calls, an array counts once
+	uint64_t bufferBytes; // vertex and index data
+	uint64_t textureBytes; // pixels or blocks, as they were handed to opengl
+};
+
+/* Per frame counters. The wrappers add to current() as they call opengl, which is an increment of a
+ * global: everything that calls opengl is on one thread, so there's nothing to synchronise.
+ * endFrame() keeps the frame's numbers, writes them to the CSV file if there is one and starts over.
+ * Comparing the CSV of two builds shows what a change did to the work per frame */
+class RenderStats
+{
+private:
+	static FrameStats s_Current;
+public:
+	static inline FrameStats& current() { return s_Current; }
+	static void endFrame();
+	/* the numbers of the frame before the current one */
+	static const FrameStats& getLastFrame();
+
+	/* from the next endFrame() on, a line per frame with a header line first. false if it can't be written */
+	static bool openCsv(const std::string& filePath);
+	static void closeCsv();
+};
+
+
+#endif //OPENGL_THECHERNO_RENDERSTATS_H
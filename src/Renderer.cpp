@@ -7,6 +7,9 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "GpuProfiler.h"
+#include "Profiler.h"
+#include "RenderStats.h"
 
 void glClearError()
 {
@@ -17,12 +20,27 @@ void glClearError()
      * Thus, glGetError should always be called in a loop,
      * until it returns GL_NO_ERROR, if all error flags are to be reset.
      * */
+#ifdef GL_SYNC_DIAGNOSTICS
+	SyncPointDetector::beginErrorCheck();
+	unsigned int calls = 1;
+	while (glGetError() != GL_NO_ERROR)
+		calls++;
+	SyncPointDetector::endErrorCheck(calls);
+#else
     while (glGetError() != GL_NO_ERROR); // reset all error flags
+#endif
 }
 
 bool glLogCall(const char* function, const char* file, int line)
 {
-    while(GLenum error = glGetError())
+#ifdef GL_SYNC_DIAGNOSTICS
+	SyncPointDetector::beginErrorCheck();
+	const GLenum error = glGetError();
+	SyncPointDetector::endErrorCheck(1);
+#else
+	const GLenum error = glGetError();
+#endif
+    if(error != GL_NO_ERROR)
     {
         std::cout << "[OpenGL Error] (0x0" << std::hex << error << std::dec << ") occurred in "
                   << function << " at " <<
@@ -33,8 +51,18 @@ bool glLogCall(const char* function, const char* file, int line)
     return true;
 }
 
-void Renderer::draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
+static void countDraw(unsigned int indexCount)
 {
+	FrameStats& stats = RenderStats::current();
+	stats.drawCalls++;
+	stats.indices += indexCount;
+	stats.triangles += indexCount / 3;
+}
+
+void Renderer::draw(const VertexArray& va, const IndexBuffer& ib, Shader& shader) const
+{
+	PROFILE_SCOPE("Renderer::draw");
+	GpuScope gpuScope(m_GpuProfiler, "Renderer::draw");
 	/* After resetting all our bindings, we just need to bind our vao
 	 * binding vertex buffer and setting up its layout becomes binding the vertex array object because
 	 * this vao contains all the state we actually need
@@ -43,7 +71,11 @@ void Renderer::draw(const VertexArray& va, const IndexBuffer& ib, const Shader&
 	 * in glVertexAttribPointer(), vao gets linked to vertex buffer and the layout.
 	 * so calling glBindVertexArray(vao) is enough here
 	 * */
+	// we are binding things behind the materials' back, so forget what they bound
+	resetState();
 	shader.bind();
+	// the uniforms set since the last draw with this shader, and only the ones whose value changed
+	shader.uploadUniforms();
 	va.bind();
 	ib.bind();
 
@@ -52,10 +84,30 @@ void Renderer::draw(const VertexArray& va, const IndexBuffer& ib, const Shader&
 	// since we already bound index buffer above as glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ib)
 	// we can pass nullptr to 4th argument
 	glCall(glDrawElements(GL_TRIANGLES, ib.getCount(), GL_UNSIGNED_INT, nullptr));
+	countDraw(ib.getCount());
+}
+
+void Renderer::draw(const VertexArray& va, const IndexBuffer& ib, const Material& material) const
+{
+	PROFILE_SCOPE("Renderer::draw");
+	GpuScope gpuScope(m_GpuProfiler, "Renderer::draw");
+	// binds only the shader, textures and uniforms that differ from the previous material
+	material.bind(m_MaterialState);
+	va.bind();
+	ib.bind();
+
+	glCall(glDrawElements(GL_TRIANGLES, ib.getCount(), GL_UNSIGNED_INT, nullptr));
+	countDraw(ib.getCount());
+}
+
+void Renderer::resetState() const
+{
+	m_MaterialState = MaterialBindState();
 }
 
 void Renderer::clear() const
 {
+	PROFILE_SCOPE("Renderer::clear");
 	/* Render here */
 	glClear(GL_COLOR_BUFFER_BIT);
 }
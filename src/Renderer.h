@@ -6,24 +6,47 @@
 #define OPENGL_THECHERNO_RENDERER_H
 
 #include <GL/glew.h>
+#include "Material.h"
+#include "SyncPointDetector.h"
 
 class VertexArray;
 class IndexBuffer;
 class Shader;
+class GpuProfiler;
 
 #define ASSERT(x) if(!(x)) __builtin_trap();
+#ifdef GL_SYNC_DIAGNOSTICS
+/* times the call and counts it as async or synchronising, see SyncPointDetector.h */
 #define glCall(x) glClearError();\
+    SyncPointDetector::beginCall();\
     x;\
+    SyncPointDetector::endCall(#x, __FILE__, __LINE__);\
     ASSERT(glLogCall(#x, __FILE__, __LINE__))
+#else
+#define glCall(x) glClearError();\
+    x;\
+    ASSERT(glLogCall(#x, __FILE__, __LINE__))
+#endif
 
 void glClearError();
 bool glLogCall(const char* function, const char* file, int line);
 
 class Renderer
 {
+private:
+	// what the last draw with a material bound, so that the next one only changes what differs
+	mutable MaterialBindState m_MaterialState;
+	GpuProfiler* m_GpuProfiler = nullptr;
 public:
 	void clear() const;
-	void draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+	void draw(const VertexArray& va, const IndexBuffer& ib, Shader& shader) const;
+	void draw(const VertexArray& va, const IndexBuffer& ib, const Material& material) const;
+
+	/* call this after binding shaders or textures yourself, the renderer can't see those */
+	void resetState() const;
+
+	/* every draw becomes a scope of the profiler, nullptr stops that */
+	inline void setGpuProfiler(GpuProfiler* profiler) { m_GpuProfiler = profiler; }
 };
 
 #endif //OPENGL_THECHERNO_RENDERER_H
@@ -4,34 +4,107 @@
 
 #include "Shader.h"
 #include "Renderer.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "GLObjectRegistry.h"
+#include "Material.h"
+#include "ShaderPack.h"
+#include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <utility>
 #include <iostream>
 
-struct ShaderProgramSource
-{
-	std::string vertexSource;
-	std::string fragmentSource;
-};
-
-Shader::Shader(const std::string& filepath)
+Shader::Shader(const std::string& filepath, std::source_location location)
 	:m_filepath(filepath), m_RendererID(0)
 {
+	PROFILE_SCOPE("Shader::Shader");
 	// directories are relative to the location of the executable. NOT to the main.cpp
 	ShaderProgramSource source = parseShader(filepath);
 
 	/* Ok now that you've read from shader file, create a shader program for me*/
 	m_RendererID = createProgram(source.vertexSource, source.fragmentSource);
+	reflectUniforms();
+	GLObjectRegistry::add(GLObjectType::Shader, m_RendererID, 0, location);
+}
+
+Shader::Shader(const ShaderPack& pack, std::string_view name, const ShaderSpecialization& specialization, std::source_location location)
+	:m_RendererID(0), m_filepath(name)
+{
+	PROFILE_SCOPE("Shader::Shader");
+	ShaderPackProgram program{};
+	if(!pack.find(name, program))
+	{
+		std::cout << "Shader '" << name << "' is not in the shader pack!" << std::endl;
+		return;
+	}
+
+	/* SPIR-V was parsed and optimised by glslang at build time, so the driver only has to turn it into machine code */
+	bool reflected = false;
+	if(!program.spirvVertex.empty() && !program.spirvFragment.empty() && GLEW_ARB_gl_spirv)
+		m_RendererID = createProgramFromSpirv(program.spirvVertex, program.spirvFragment, specialization);
+
+	/* the uniforms are looked up by name, and SPIR-V doesn't have to keep the names (glslang strips them
+	 * when told to). Without them no setUniform would find anything, so use the GLSL */
+	if(m_RendererID != 0 && !(reflected = reflectUniforms()))
+	{
+		std::cout << "Warning: SPIR-V of shader '" << name << "' has uniforms without names, using its GLSL" << std::endl;
+		glCall(glDeleteProgram(m_RendererID));
+		m_RendererID = 0;
+	}
+
+	if(m_RendererID == 0 && !specialization.empty())
+		std::cout << "Warning: shader '" << name << "' is built from GLSL, its specialization constants keep their defaults" << std::endl;
+
+	/* A program binary skips compiling and linking altogether, but it only works on the driver that made it.
+	 * If it's from somewhere else (or the driver just refuses it) we compile the sources as usual.
+	 * The binary was linked with the default constants, so a specialized variant can't use it */
+	if(m_RendererID == 0 && specialization.empty() && program.binary && pack.getDriver() == ShaderPack::getCurrentDriver())
+		m_RendererID = createProgramFromBinary(program.binaryFormat, program.binary, program.binaryLength);
+
+	if(m_RendererID == 0)
+		m_RendererID = createProgram(program.vertexSource, program.fragmentSource);
+	if(!reflected)
+		reflectUniforms();
+	GLObjectRegistry::add(GLObjectType::Shader, m_RendererID, 0, location);
+}
+
+Shader::Shader(std::string_view name, std::string_view vertexSource, std::string_view fragmentSource, std::source_location location)
+	:m_RendererID(0), m_filepath(name)
+{
+	PROFILE_SCOPE("Shader::Shader");
+	m_RendererID = createProgram(vertexSource, fragmentSource);
+	reflectUniforms();
+	GLObjectRegistry::add(GLObjectType::Shader, m_RendererID, 0, location);
 }
 
 Shader::~Shader()
 {
 	/* delete the shader program now that our window is closed and program is about to exit*/
+	GLObjectRegistry::remove(GLObjectType::Shader, m_RendererID);
 	glCall(glDeleteProgram(m_RendererID));
+	MaterialBindState::forgetAll();
+}
+
+Shader::Shader(Shader&& other) noexcept
+	: m_RendererID(std::exchange(other.m_RendererID, 0)), m_filepath(std::move(other.m_filepath)),
+	m_Uniforms(std::move(other.m_Uniforms)), m_MissingUniforms(std::move(other.m_MissingUniforms))
+{
+}
+
+/* the other one takes our program along and deletes it */
+Shader& Shader::operator=(Shader&& other) noexcept
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_filepath, other.m_filepath);
+	std::swap(m_Uniforms, other.m_Uniforms);
+	std::swap(m_MissingUniforms, other.m_MissingUniforms);
+	return *this;
 }
 
 void Shader::bind() const
 {
+	RenderStats::current().programBinds++;
 	glCall(glUseProgram(m_RendererID));
 }
 
@@ -40,27 +113,115 @@ void Shader::unBind() const
 	glCall(glUseProgram(0));
 }
 
-void Shader::setUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+UniformHandle Shader::getUniformHandle(const UniformName& name) const
 {
-	glCall(glUniform4f(getUniformLocation(name), v0, v1, v2, v3));
+	UniformHandle handle = m_Uniforms.find(name);
+	if(!handle.isValid())
+	{
+		/* an invalid handle gives location -1, and opengl silently ignores glUniform calls on -1.
+		 * so all we have to do is warn, once per name */
+		if(shouldWarn(name.hash))
+			std::cout << "Warning: uniform '" << name.name << "' doesn't exist!" << std::endl;
+	}
+	return handle;
+}
+
+bool Shader::shouldWarn(uint32_t nameHash) const
+{
+	for(uint32_t hash : m_MissingUniforms)
+	{
+		if(hash == nameHash)
+			return false;
+	}
+	m_MissingUniforms.push_back(nameHash);
+	return true;
 }
 
-int Shader::getUniformLocation(const std::string& name)
+bool Shader::reflectUniforms()
 {
-	if(m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-		return m_UniformLocationCache[name];
+	m_Uniforms.clear();
 
-	/* Each uniform (variable) we write in our shader will get assigned an id (location)
-	 * So we are asking opengl to give us that id (location) after writing the glUseProgram()
-	 * 1. the first argument is the shaderProgram which has the uniform
-	 * 2. the second argument is the name of the uniform (we called our uniform u_Color in our shader)
+	/* Instead of asking opengl for a location every time we see a new name, we ask the linked program
+	 * for all its active uniforms once. Uniforms the compiler optimised away are not active,
+	 * so they won't be in here (and glGetUniformLocation would have given -1 for them anyway)
 	 * */
-	glCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
-	if(location == -1)
-		std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
+	int count = 0;
+	int maxLength = 0;
+	glCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+	glCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+
+	std::vector<char> nameBuffer(maxLength > 0 ? maxLength : 1);
+	bool named = true;
+	for(int i = 0; i < count; i++)
+	{
+		int length = 0;
+		int size = 0;
+		GLenum type = 0;
+		glCall(glGetActiveUniform(m_RendererID, i, maxLength, &length, &size, &type, nameBuffer.data()));
 
-	m_UniformLocationCache[name] = location;
-	return location;
+		/* Uniforms inside uniform blocks have no location, they are set through buffers.
+		 * SPIR-V programs don't have to keep the names of their uniforms (glslang keeps them unless
+		 * told to strip them), so where we can we ask for the location by index and not by name */
+		int location = -1;
+		if(GLEW_ARB_program_interface_query)
+		{
+			const GLenum property = GL_LOCATION;
+			glCall(glGetProgramResourceiv(m_RendererID, GL_UNIFORM, i, 1, &property, 1, nullptr, &location));
+		}
+		else
+		{
+			glCall(location = glGetUniformLocation(m_RendererID, nameBuffer.data()));
+		}
+		if(location == -1)
+			continue;
+		if(length == 0)
+		{
+			std::cout << "Warning: shader '" << m_filepath << "' has a uniform without a name at location " << location << std::endl;
+			named = false;
+			continue; // nothing could look it up
+		}
+
+		// arrays are reported as "u_Name[0]", but we want to look them up as "u_Name"
+		std::string name(nameBuffer.data(), length);
+		if(name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+			name.resize(name.size() - 3);
+
+		const UniformHandle handle = m_Uniforms.add(std::move(name), location, type, size);
+		readInitialValue(handle);
+	}
+	return named;
+}
+
+void Shader::readInitialValue(UniformHandle handle)
+{
+	/* the shadow has to hold what the program really has, or setting a uniform to 0 that the GLSL
+	 * initialised to something else would look like no change and never be uploaded. Once per uniform
+	 * at load time, the glGetUniform calls wait for the driver but nothing is drawing yet */
+	const UniformInfo& info = m_Uniforms[handle];
+	const UniformTypeInfo type = getUniformTypeInfo(info.type);
+	if(type.componentType == 0)
+		return; // we can't set it either
+
+	std::vector<uint32_t> value(info.elementSize / sizeof(uint32_t) * info.count);
+	for(int element = 0; element < info.count; element++)
+	{
+		// the elements of an array of a basic type have consecutive locations
+		uint32_t* data = value.data() + element * type.components;
+		if(type.componentType == GL_FLOAT)
+		{
+			glCall(glGetUniformfv(m_RendererID, info.location + element, reinterpret_cast<float*>(data)));
+		}
+		else if(type.componentType == GL_UNSIGNED_INT)
+		{
+			glCall(glGetUniformuiv(m_RendererID, info.location + element, data));
+		}
+		else
+		{
+			// ints, samplers and bools, which come back as 0 or 1
+			glCall(glGetUniformiv(m_RendererID, info.location + element, reinterpret_cast<int*>(data)));
+		}
+	}
+	m_Uniforms.setInitialValue(handle, value.data(), info.elementSize * info.count);
 }
 
 ShaderProgramSource Shader::parseShader(const std::string& filePath)
@@ -89,7 +250,7 @@ ShaderProgramSource Shader::parseShader(const std::string& filePath)
 				type = ShaderType::FRAGMENT;
 			}
 		}
-		else
+		else if(type != ShaderType::NONE) // lines before the first #shader don't belong to any shader
 		{
 			ss[(int)type] << line << "\n";
 		}
@@ -97,11 +258,22 @@ ShaderProgramSource Shader::parseShader(const std::string& filePath)
 	return { ss[0].str(), ss[1].str()};
 }
 
-unsigned int Shader::compileShader(unsigned int type, const std::string& source)
+bool Shader::isLinked() const
+{
+	if(m_RendererID == 0)
+		return false;
+
+	int linked = GL_FALSE;
+	glCall(glGetProgramiv(m_RendererID, GL_LINK_STATUS, &linked));
+	return linked == GL_TRUE;
+}
+
+unsigned int Shader::compileShader(unsigned int type, std::string_view source)
 {
 	/* create a shader of type vertex_shader and give its id */
 	unsigned int id = glCreateShader(type);
-	const char* src = source.c_str();
+	const char* src = source.data();
+	const int srcLength = static_cast<int>(source.size());
 
 	/* So, you created a shader and gave me an id. Good.
 	 * Now, I will tell where the shader code is
@@ -113,8 +285,9 @@ unsigned int Shader::compileShader(unsigned int type, const std::string& source)
 	 * (why can't you just take the pointer to source string, openGL?)
 	 * 4. If the length is null, the string is assumed to be null terminated
 	 * Refer http://docs.gl/gl4/glShaderSource for alternatives for 4th argument
+	 * We pass the length, because a string_view doesn't have to end in a null
 	 * */
-	glCall(glShaderSource(id, 1, &src, nullptr));
+	glCall(glShaderSource(id, 1, &src, &srcLength));
 
 	/* Now that you know the shader source string and other details, compile the shader*/
 	glCall(glCompileShader(id));
@@ -153,13 +326,19 @@ unsigned int Shader::compileShader(unsigned int type, const std::string& source)
 	return id;
 }
 
-unsigned int Shader::createProgram(const std::string& vertexShader, const std::string& fragmentShader)
+unsigned int Shader::createProgram(std::string_view vertexShader, std::string_view fragmentShader)
 {
 	/* I want to write a shader program. So create one, and give me its id back*/
 	unsigned int program = glCreateProgram();
 	unsigned int vs = compileShader(GL_VERTEX_SHADER, vertexShader);
 	unsigned int fs = compileShader(GL_FRAGMENT_SHADER, fragmentShader);
 
+	/* tell the driver that we may ask for the linked binary (the shader packer stores it) */
+	if(GLEW_ARB_get_program_binary)
+	{
+		glCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+	}
+
 	/* After compiling shaders, attach them to the above created program*/
 	glCall(glAttachShader(program, vs));
 	glCall(glAttachShader(program, fs));
@@ -186,7 +365,354 @@ unsigned int Shader::createProgram(const std::string& vertexShader, const std::s
 	return program;
 }
 
-void Shader::setUniform1i(const std::string& name, int value)
+UniformHandle Shader::resolve(const UniformRef& uniform) const
+{
+	if(uniform.handle.isValid() || uniform.name.name.empty())
+		return uniform.handle;
+	return getUniformHandle(uniform.name);
+}
+
+static bool isAssignable(unsigned int uniformType, unsigned int valueType)
 {
-	glCall(glUniform1i(getUniformLocation(name), value));
+	if(uniformType == valueType)
+		return true;
+
+	UniformTypeInfo uniform = getUniformTypeInfo(uniformType);
+	UniformTypeInfo value = getUniformTypeInfo(valueType);
+
+	// samplers take the texture slot as an int
+	if(uniform.sampler)
+		return valueType == GL_INT;
+
+	// bools can be set with any of the int, uint or float setters of the same size
+	return uniform.componentType == GL_BOOL && value.componentType != 0
+		&& uniform.components == value.components && value.columns == 1;
+}
+
+void Shader::setUniform(const UniformRef& uniform, unsigned int type, const void* data, int count)
+{
+	UniformHandle handle = resolve(uniform);
+	if(!handle.isValid())
+		return; // we already warned that it doesn't exist
+
+	const UniformInfo& info = m_Uniforms[handle];
+	if(getUniformTypeInfo(info.type).componentType == 0)
+	{
+		/* a type we don't know how to set (doubles, atomic counters, or one newer than this list). It isn't
+		 * the caller's mistake, so it's ignored like a missing uniform instead of stopping */
+		if(shouldWarn(info.hash))
+			std::cout << "Warning: uniform '" << info.name << "' has a type we can't set (0x" << std::hex << info.type
+					  << std::dec << "), ignoring it" << std::endl;
+		return;
+	}
+	if(!isAssignable(info.type, type))
+	{
+		/* opengl would give us GL_INVALID_OPERATION for this, so we stop just like glCall would */
+		std::cout << "[Uniform Error] '" << info.name << "' is a " << getUniformTypeInfo(info.type).glslName
+				  << ", it can't be set with a " << getUniformTypeInfo(type).glslName << std::endl;
+		ASSERT(false);
+		return;
+	}
+	if(count > info.count)
+	{
+		std::cout << "Warning: uniform '" << info.name << "' has " << info.count << " elements, ignoring the other "
+				  << count - info.count << std::endl;
+		count = info.count;
+	}
+
+	m_Uniforms.write(handle, data, count * info.elementSize);
+}
+
+unsigned int Shader::createProgramFromBinary(unsigned int format, const void* binary, unsigned int length)
+{
+	if(!GLEW_ARB_get_program_binary)
+		return 0;
+
+	// a format this driver doesn't know would be GL_INVALID_ENUM, so check before handing it over
+	int formatCount = 0;
+	glCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount));
+	std::vector<int> formats(formatCount);
+	if(formatCount > 0)
+	{
+		glCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data()));
+	}
+	if(std::find(formats.begin(), formats.end(), static_cast<int>(format)) == formats.end())
+		return 0;
+
+	unsigned int program = glCreateProgram();
+	glCall(glProgramBinary(program, format, binary, static_cast<int>(length)));
+
+	/* the driver is allowed to reject a binary (after an update for example), then the link status is false */
+	int linked = GL_FALSE;
+	glCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	if(linked == GL_FALSE)
+	{
+		glCall(glDeleteProgram(program));
+		return 0;
+	}
+	return program;
+}
+
+unsigned int Shader::specializeShader(unsigned int type, std::string_view module, const ShaderSpecialization& specialization)
+{
+	unsigned int id = glCreateShader(type);
+
+	/* With SPIR-V there is no glShaderSource and glCompileShader. We hand over the module,
+	 * and glSpecializeShader picks the entry point and fixes the specialization constants */
+	glCall(glShaderBinary(1, &id, GL_SHADER_BINARY_FORMAT_SPIR_V_ARB, module.data(), static_cast<int>(module.size())));
+	glCall(glSpecializeShaderARB(id, "main", static_cast<unsigned int>(specialization.constantIDs.size()),
+			specialization.constantIDs.data(), specialization.values.data()));
+
+	int result = GL_FALSE;
+	glCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
+	if(result == GL_FALSE)
+	{
+		int length = 0;
+		glCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
+		std::vector<char> message(length > 0 ? length : 1);
+		glCall(glGetShaderInfoLog(id, static_cast<int>(message.size()), &length, message.data()));
+		std::cout << "Failed to specialize " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
+				  << " SPIR-V module!" << std::endl;
+		std::cout << message.data() << std::endl;
+
+		glCall(glDeleteShader(id));
+		return 0;
+	}
+	return id;
+}
+
+unsigned int Shader::createProgramFromSpirv(std::string_view vertexModule, std::string_view fragmentModule,
+		const ShaderSpecialization& specialization)
+{
+	unsigned int vs = specializeShader(GL_VERTEX_SHADER, vertexModule, specialization);
+	unsigned int fs = specializeShader(GL_FRAGMENT_SHADER, fragmentModule, specialization);
+	if(vs == 0 || fs == 0)
+	{
+		// glDeleteShader ignores 0, so this is fine for the one that did work
+		glCall(glDeleteShader(vs));
+		glCall(glDeleteShader(fs));
+		return 0; // the caller falls back to the GLSL sources
+	}
+
+	unsigned int program = glCreateProgram();
+	glCall(glAttachShader(program, vs));
+	glCall(glAttachShader(program, fs));
+	glCall(glLinkProgram(program));
+	glCall(glDeleteShader(vs));
+	glCall(glDeleteShader(fs));
+
+	int linked = GL_FALSE;
+	glCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	if(linked == GL_FALSE)
+	{
+		glCall(glDeleteProgram(program));
+		return 0;
+	}
+	return program;
+}
+
+void Shader::setUniform1f(UniformRef uniform, float v0)
+{
+	setUniform(uniform, GL_FLOAT, &v0, 1);
+}
+
+void Shader::setUniform2f(UniformRef uniform, float v0, float v1)
+{
+	const float values[] = {v0, v1};
+	setUniform(uniform, GL_FLOAT_VEC2, values, 1);
+}
+
+void Shader::setUniform3f(UniformRef uniform, float v0, float v1, float v2)
+{
+	const float values[] = {v0, v1, v2};
+	setUniform(uniform, GL_FLOAT_VEC3, values, 1);
+}
+
+void Shader::setUniform4f(UniformRef uniform, float v0, float v1, float v2, float v3)
+{
+	const float values[] = {v0, v1, v2, v3};
+	setUniform(uniform, GL_FLOAT_VEC4, values, 1);
+}
+
+void Shader::setUniform1i(UniformRef uniform, int v0)
+{
+	setUniform(uniform, GL_INT, &v0, 1);
+}
+
+void Shader::setUniform2i(UniformRef uniform, int v0, int v1)
+{
+	const int values[] = {v0, v1};
+	setUniform(uniform, GL_INT_VEC2, values, 1);
+}
+
+void Shader::setUniform3i(UniformRef uniform, int v0, int v1, int v2)
+{
+	const int values[] = {v0, v1, v2};
+	setUniform(uniform, GL_INT_VEC3, values, 1);
+}
+
+void Shader::setUniform4i(UniformRef uniform, int v0, int v1, int v2, int v3)
+{
+	const int values[] = {v0, v1, v2, v3};
+	setUniform(uniform, GL_INT_VEC4, values, 1);
+}
+
+void Shader::setUniform1ui(UniformRef uniform, unsigned int v0)
+{
+	setUniform(uniform, GL_UNSIGNED_INT, &v0, 1);
+}
+
+void Shader::setUniform2ui(UniformRef uniform, unsigned int v0, unsigned int v1)
+{
+	const unsigned int values[] = {v0, v1};
+	setUniform(uniform, GL_UNSIGNED_INT_VEC2, values, 1);
+}
+
+void Shader::setUniform3ui(UniformRef uniform, unsigned int v0, unsigned int v1, unsigned int v2)
+{
+	const unsigned int values[] = {v0, v1, v2};
+	setUniform(uniform, GL_UNSIGNED_INT_VEC3, values, 1);
+}
+
+void Shader::setUniform4ui(UniformRef uniform, unsigned int v0, unsigned int v1, unsigned int v2, unsigned int v3)
+{
+	const unsigned int values[] = {v0, v1, v2, v3};
+	setUniform(uniform, GL_UNSIGNED_INT_VEC4, values, 1);
+}
+
+void Shader::setUniform1fv(UniformRef uniform, int count, const float* values)
+{
+	setUniform(uniform, GL_FLOAT, values, count);
+}
+
+void Shader::setUniform2fv(UniformRef uniform, int count, const float* values)
+{
+	setUniform(uniform, GL_FLOAT_VEC2, values, count);
+}
+
+void Shader::setUniform3fv(UniformRef uniform, int count, const float* values)
+{
+	setUniform(uniform, GL_FLOAT_VEC3, values, count);
+}
+
+void Shader::setUniform4fv(UniformRef uniform, int count, const float* values)
+{
+	setUniform(uniform, GL_FLOAT_VEC4, values, count);
+}
+
+void Shader::setUniform1iv(UniformRef uniform, int count, const int* values)
+{
+	setUniform(uniform, GL_INT, values, count);
+}
+
+void Shader::setUniform2iv(UniformRef uniform, int count, const int* values)
+{
+	setUniform(uniform, GL_INT_VEC2, values, count);
+}
+
+void Shader::setUniform3iv(UniformRef uniform, int count, const int* values)
+{
+	setUniform(uniform, GL_INT_VEC3, values, count);
+}
+
+void Shader::setUniform4iv(UniformRef uniform, int count, const int* values)
+{
+	setUniform(uniform, GL_INT_VEC4, values, count);
+}
+
+void Shader::setUniform1uiv(UniformRef uniform, int count, const unsigned int* values)
+{
+	setUniform(uniform, GL_UNSIGNED_INT, values, count);
+}
+
+void Shader::setUniform2uiv(UniformRef uniform, int count, const unsigned int* values)
+{
+	setUniform(uniform, GL_UNSIGNED_INT_VEC2, values, count);
+}
+
+void Shader::setUniform3uiv(UniformRef uniform, int count, const unsigned int* values)
+{
+	setUniform(uniform, GL_UNSIGNED_INT_VEC3, values, count);
+}
+
+void Shader::setUniform4uiv(UniformRef uniform, int count, const unsigned int* values)
+{
+	setUniform(uniform, GL_UNSIGNED_INT_VEC4, values, count);
+}
+
+void Shader::setUniformMat2f(UniformRef uniform, const float* matrix, int count)
+{
+	setUniform(uniform, GL_FLOAT_MAT2, matrix, count);
+}
+
+void Shader::setUniformMat3f(UniformRef uniform, const float* matrix, int count)
+{
+	setUniform(uniform, GL_FLOAT_MAT3, matrix, count);
+}
+
+void Shader::setUniformMat4f(UniformRef uniform, const float* matrix, int count)
+{
+	setUniform(uniform, GL_FLOAT_MAT4, matrix, count);
+}
+
+void Shader::uploadUniforms()
+{
+	for(int index : m_Uniforms.getDirty())
+	{
+		const UniformHandle handle = {index};
+		const UniformInfo& info = m_Uniforms[handle];
+		const UniformTypeInfo type = getUniformTypeInfo(info.type);
+		const void* value = m_Uniforms.getValue(handle);
+		RenderStats::current().uniformUploads++;
+
+		const auto* f = static_cast<const float*>(value);
+		const auto* i = static_cast<const int*>(value);
+		const auto* ui = static_cast<const unsigned int*>(value);
+
+		switch(info.type)
+		{
+			case GL_FLOAT_MAT2:		glCall(glUniformMatrix2fv(info.location, info.count, GL_FALSE, f)); continue;
+			case GL_FLOAT_MAT3:		glCall(glUniformMatrix3fv(info.location, info.count, GL_FALSE, f)); continue;
+			case GL_FLOAT_MAT4:		glCall(glUniformMatrix4fv(info.location, info.count, GL_FALSE, f)); continue;
+			case GL_FLOAT_MAT2x3:	glCall(glUniformMatrix2x3fv(info.location, info.count, GL_FALSE, f)); continue;
+			case GL_FLOAT_MAT2x4:	glCall(glUniformMatrix2x4fv(info.location, info.count, GL_FALSE, f)); continue;
+			case GL_FLOAT_MAT3x2:	glCall(glUniformMatrix3x2fv(info.location, info.count, GL_FALSE, f)); continue;
+			case GL_FLOAT_MAT3x4:	glCall(glUniformMatrix3x4fv(info.location, info.count, GL_FALSE, f)); continue;
+			case GL_FLOAT_MAT4x2:	glCall(glUniformMatrix4x2fv(info.location, info.count, GL_FALSE, f)); continue;
+			case GL_FLOAT_MAT4x3:	glCall(glUniformMatrix4x3fv(info.location, info.count, GL_FALSE, f)); continue;
+		}
+
+		/* everything else is a vector of 1 to 4 components. bools and samplers go through the int version */
+		if(type.componentType == GL_FLOAT)
+		{
+			switch(type.components)
+			{
+				case 1: glCall(glUniform1fv(info.location, info.count, f)); break;
+				case 2: glCall(glUniform2fv(info.location, info.count, f)); break;
+				case 3: glCall(glUniform3fv(info.location, info.count, f)); break;
+				case 4: glCall(glUniform4fv(info.location, info.count, f)); break;
+			}
+		}
+		else if(type.componentType == GL_UNSIGNED_INT)
+		{
+			switch(type.components)
+			{
+				case 1: glCall(glUniform1uiv(info.location, info.count, ui)); break;
+				case 2: glCall(glUniform2uiv(info.location, info.count, ui)); break;
+				case 3: glCall(glUniform3uiv(info.location, info.count, ui)); break;
+				case 4: glCall(glUniform4uiv(info.location, info.count, ui)); break;
+			}
+		}
+		else if(type.componentType == GL_INT || type.componentType == GL_BOOL)
+		{
+			switch(type.components)
+			{
+				case 1: glCall(glUniform1iv(info.location, info.count, i)); break;
+				case 2: glCall(glUniform2iv(info.location, info.count, i)); break;
+				case 3: glCall(glUniform3iv(info.location, info.count, i)); break;
+				case 4: glCall(glUniform4iv(info.location, info.count, i)); break;
+			}
+		}
+	}
+	m_Uniforms.clearDirty();
 }
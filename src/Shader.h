@@ -5,33 +5,129 @@
 #ifndef OPENGL_THECHERNO_SHADER_H
 #define OPENGL_THECHERNO_SHADER_H
 
+#include <source_location>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
+#include "UniformTable.h"
 
-struct ShaderProgramSource;
+class ShaderPack;
+
+struct ShaderProgramSource
+{
+	std::string vertexSource;
+	std::string fragmentSource;
+};
+
+/* Values for the specialization constants (layout(constant_id = N) const ...) of a SPIR-V shader.
+ * Each set of values is its own variant of the program, without compiling the GLSL again */
+struct ShaderSpecialization
+{
+	std::vector<unsigned int> constantIDs;
+	std::vector<unsigned int> values; // the bits of the value, use std::bit_cast for floats
+
+	inline void set(unsigned int constantID, unsigned int value)
+	{
+		constantIDs.push_back(constantID);
+		values.push_back(value);
+	}
+	inline bool empty() const { return constantIDs.empty(); }
+};
 
 class Shader
 {
 private:
 	unsigned int m_RendererID;
 	std::string m_filepath;
-	// caching for uniforms
-	std::unordered_map<std::string, int> m_UniformLocationCache;
+	// every active uniform of the program, reflected once after linking
+	UniformTable m_Uniforms;
+	// hashes of the names we already warned about, so that we don't warn every frame
+	mutable std::vector<uint32_t> m_MissingUniforms;
 public:
-	Shader(const std::string& filepath);
+	Shader(const std::string& filepath, std::source_location location = std::source_location::current());
+	/* Takes the shader straight out of the mapped pack, no file is opened and nothing is copied.
+	 * In order of preference it uses the SPIR-V modules (when the driver has ARB_gl_spirv),
+	 * the program binary (when it was made by this driver) and then the GLSL sources.
+	 * The specialization is only applied to SPIR-V, GLSL keeps the constants' default values */
+	Shader(const ShaderPack& pack, std::string_view name, const ShaderSpecialization& specialization = {},
+			std::source_location location = std::source_location::current());
+	Shader(std::string_view name, std::string_view vertexSource, std::string_view fragmentSource,
+			std::source_location location = std::source_location::current());
 	~Shader();
 
+	/* owns its program: moves, but a copy would delete the program twice. Materials refer to the shader,
+	 * so don't move one that a material uses */
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
+
 	void bind() const;
 	void unBind() const;
 
-	void setUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
-	void setUniform1i(const std::string& name, int value);
+	inline unsigned int getRendererID() const { return m_RendererID; }
+	bool isLinked() const;
+
+	/* splits a .shader file into its vertex and fragment parts */
+	static ShaderProgramSource parseShader(const std::string& filePath);
+
+	UniformHandle getUniformHandle(const UniformName& name) const;
+	inline const UniformInfo& getUniformInfo(UniformHandle handle) const { return m_Uniforms[handle]; }
+
+	/* The setters only write to the shader's CPU copy of the uniforms. Values that actually
+	 * changed are sent to opengl by uploadUniforms(), which Renderer::draw calls after binding.
+	 * Every setter takes a handle or a name, and checks the value against the type in the shader */
+	void setUniform1f(UniformRef uniform, float v0);
+	void setUniform2f(UniformRef uniform, float v0, float v1);
+	void setUniform3f(UniformRef uniform, float v0, float v1, float v2);
+	void setUniform4f(UniformRef uniform, float v0, float v1, float v2, float v3);
+	void setUniform1i(UniformRef uniform, int v0);
+	void setUniform2i(UniformRef uniform, int v0, int v1);
+	void setUniform3i(UniformRef uniform, int v0, int v1, int v2);
+	void setUniform4i(UniformRef uniform, int v0, int v1, int v2, int v3);
+	void setUniform1ui(UniformRef uniform, unsigned int v0);
+	void setUniform2ui(UniformRef uniform, unsigned int v0, unsigned int v1);
+	void setUniform3ui(UniformRef uniform, unsigned int v0, unsigned int v1, unsigned int v2);
+	void setUniform4ui(UniformRef uniform, unsigned int v0, unsigned int v1, unsigned int v2, unsigned int v3);
+
+	// arrays. count is the number of array elements, so a vec3[4] takes count 4 and 12 floats
+	void setUniform1fv(UniformRef uniform, int count, const float* values);
+	void setUniform2fv(UniformRef uniform, int count, const float* values);
+	void setUniform3fv(UniformRef uniform, int count, const float* values);
+	void setUniform4fv(UniformRef uniform, int count, const float* values);
+	void setUniform1iv(UniformRef uniform, int count, const int* values);
+	void setUniform2iv(UniformRef uniform, int count, const int* values);
+	void setUniform3iv(UniformRef uniform, int count, const int* values);
+	void setUniform4iv(UniformRef uniform, int count, const int* values);
+	void setUniform1uiv(UniformRef uniform, int count, const unsigned int* values);
+	void setUniform2uiv(UniformRef uniform, int count, const unsigned int* values);
+	void setUniform3uiv(UniformRef uniform, int count, const unsigned int* values);
+	void setUniform4uiv(UniformRef uniform, int count, const unsigned int* values);
+
+	// matrices are column major, like opengl wants them
+	void setUniformMat2f(UniformRef uniform, const float* matrix, int count = 1);
+	void setUniformMat3f(UniformRef uniform, const float* matrix, int count = 1);
+	void setUniformMat4f(UniformRef uniform, const float* matrix, int count = 1);
+
+	/* what all the setters above end up calling. type is the GL type of one element (GL_FLOAT_VEC4...) */
+	void setUniform(const UniformRef& uniform, unsigned int type, const void* data, int count);
+
+	/* sends every uniform that changed since the last upload. the shader has to be bound */
+	void uploadUniforms();
 
 private:
-	int getUniformLocation(const std::string& name);
-	unsigned int createProgram(const std::string& vertexShader, const std::string& fragmentShader);
-	unsigned int compileShader(unsigned int type, const std::string& source);
-	ShaderProgramSource parseShader(const std::string& filePath);
+	UniformHandle resolve(const UniformRef& uniform) const;
+	// true the first time it's asked about a name
+	bool shouldWarn(uint32_t nameHash) const;
+	/* false when a uniform that has a location has no name */
+	bool reflectUniforms();
+	void readInitialValue(UniformHandle handle);
+	unsigned int createProgram(std::string_view vertexShader, std::string_view fragmentShader);
+	unsigned int createProgramFromBinary(unsigned int format, const void* binary, unsigned int length);
+	unsigned int createProgramFromSpirv(std::string_view vertexModule, std::string_view fragmentModule,
+			const ShaderSpecialization& specialization);
+	unsigned int specializeShader(unsigned int type, std::string_view module, const ShaderSpecialization& specialization);
+	unsigned int compileShader(unsigned int type, std::string_view source);
 
 
 };
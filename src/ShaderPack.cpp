@@ -0,0 +1,133 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "ShaderPack.h"
+#include "Renderer.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ShaderPack::ShaderPack(const std::string& filePath)
+	: m_FilePath(filePath), m_Data(nullptr), m_Size(0), m_Header(nullptr), m_Entries(nullptr)
+{
+	int fd = open(filePath.c_str(), O_RDONLY);
+	if(fd < 0)
+	{
+		std::cout << "Warning: shader pack '" << filePath << "' doesn't exist!" << std::endl;
+		return;
+	}
+
+	struct stat info{};
+	if(fstat(fd, &info) == 0 && info.st_size > 0)
+	{
+		/* the whole file becomes part of our address space. pages are read in by the kernel
+		 * when we first touch them, and there is no copy into a buffer of our own */
+		void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(data != MAP_FAILED)
+		{
+			m_Data = static_cast<const unsigned char*>(data);
+			m_Size = info.st_size;
+		}
+	}
+	// the mapping stays valid after closing the file
+	close(fd);
+
+	if(!m_Data)
+	{
+		std::cout << "Failed to map shader pack '" << filePath << "'" << std::endl;
+		return;
+	}
+
+	m_Header = reinterpret_cast<const ShaderPackHeader*>(m_Data);
+	m_Entries = reinterpret_cast<const ShaderPackEntry*>(m_Data + sizeof(ShaderPackHeader));
+	if(!validate())
+	{
+		std::cout << "Shader pack '" << filePath << "' is corrupt or from another version" << std::endl;
+		m_Header = nullptr;
+		m_Entries = nullptr;
+	}
+}
+
+ShaderPack::~ShaderPack()
+{
+	if(m_Data)
+		munmap(const_cast<unsigned char*>(m_Data), m_Size);
+}
+
+bool ShaderPack::validate() const
+{
+	if(m_Size < sizeof(ShaderPackHeader) || std::memcmp(m_Header->magic, "SPAK", 4) != 0
+		|| m_Header->version != ShaderPackVersion)
+		return false;
+
+	if((m_Size - sizeof(ShaderPackHeader)) / sizeof(ShaderPackEntry) < m_Header->entryCount)
+		return false;
+
+	// every string must lie inside the file and be followed by its null terminator
+	auto inside = [this](uint32_t offset, uint32_t length, bool terminated) {
+		uint64_t end = static_cast<uint64_t>(offset) + length;
+		return end + (terminated ? 1 : 0) <= m_Size && (!terminated || m_Data[end] == '\0');
+	};
+	if(!inside(m_Header->driverOffset, m_Header->driverLength, true))
+		return false;
+
+	for(uint32_t i = 0; i < m_Header->entryCount; i++)
+	{
+		const ShaderPackEntry& entry = m_Entries[i];
+		if(!inside(entry.nameOffset, entry.nameLength, true)
+			|| !inside(entry.vertexOffset, entry.vertexLength, true)
+			|| !inside(entry.fragmentOffset, entry.fragmentLength, true)
+			|| !inside(entry.binaryOffset, entry.binaryLength, false)
+			|| !inside(entry.spirvVertexOffset, entry.spirvVertexLength, false)
+			|| !inside(entry.spirvFragmentOffset, entry.spirvFragmentLength, false))
+			return false;
+	}
+	return true;
+}
+
+std::string_view ShaderPack::getString(uint32_t offset, uint32_t length) const
+{
+	return {reinterpret_cast<const char*>(m_Data + offset), length};
+}
+
+bool ShaderPack::find(std::string_view name, ShaderPackProgram& program) const
+{
+	if(!isOpen())
+		return false;
+
+	// the packer sorted the table of contents by name
+	const ShaderPackEntry* end = m_Entries + m_Header->entryCount;
+	const ShaderPackEntry* entry = std::lower_bound(m_Entries, end, name,
+			[this](const ShaderPackEntry& e, std::string_view n) { return getString(e.nameOffset, e.nameLength) < n; });
+	if(entry == end || getString(entry->nameOffset, entry->nameLength) != name)
+		return false;
+
+	program.name = getString(entry->nameOffset, entry->nameLength);
+	program.vertexSource = getString(entry->vertexOffset, entry->vertexLength);
+	program.fragmentSource = getString(entry->fragmentOffset, entry->fragmentLength);
+	program.binaryFormat = entry->binaryFormat;
+	program.binary = entry->binaryLength ? m_Data + entry->binaryOffset : nullptr;
+	program.binaryLength = entry->binaryLength;
+	program.spirvVertex = getString(entry->spirvVertexOffset, entry->spirvVertexLength);
+	program.spirvFragment = getString(entry->spirvFragmentOffset, entry->spirvFragmentLength);
+	return true;
+}
+
+std::string_view ShaderPack::getDriver() const
+{
+	if(!isOpen())
+		return {};
+	return getString(m_Header->driverOffset, m_Header->driverLength);
+}
+
+std::string ShaderPack::getCurrentDriver()
+{
+	glCall(const auto* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+	glCall(const auto* version = reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+	return std::string(renderer ? renderer : "") + " / " + (version ? version : "");
+}
@@ -0,0 +1,93 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_SHADERPACK_H
+#define OPENGL_THECHERNO_SHADERPACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/* shaders.pack is written by tools/ShaderPacker at build time. Layout, all integers little endian:
+ *
+ *   ShaderPackHeader
+ *   ShaderPackEntry[entryCount]   (the table of contents, sorted by name)
+ *   data                          (names, sources and binaries, every string null terminated)
+ *
+ * Offsets are from the start of the file and 4 byte aligned. The sources are already split into vertex and fragment
+ * and have their #includes resolved, so the app can hand them to opengl straight out of the mapping
+ * */
+struct ShaderPackHeader
+{
+	char magic[4]; // "SPAK"
+	uint32_t version;
+	uint32_t entryCount;
+	// GL_RENDERER and GL_VERSION of the driver that made the binaries, "" if there are none
+	uint32_t driverOffset;
+	uint32_t driverLength;
+};
+
+struct ShaderPackEntry
+{
+	uint32_t nameOffset, nameLength;
+	uint32_t vertexOffset, vertexLength;
+	uint32_t fragmentOffset, fragmentLength;
+	uint32_t binaryFormat; // from glGetProgramBinary, 0 when there is no binary
+	uint32_t binaryOffset, binaryLength;
+	// SPIR-V modules compiled offline by glslang, length 0 when the build didn't make them
+	uint32_t spirvVertexOffset, spirvVertexLength;
+	uint32_t spirvFragmentOffset, spirvFragmentLength;
+};
+
+constexpr uint32_t ShaderPackVersion = 2;
+
+/* A shader inside the pack. Everything points into the mapped file, nothing is copied */
+struct ShaderPackProgram
+{
+	std::string_view name;
+	std::string_view vertexSource;
+	std::string_view fragmentSource;
+	unsigned int binaryFormat;
+	const void* binary;
+	unsigned int binaryLength;
+	// empty when there is no SPIR-V for this shader
+	std::string_view spirvVertex;
+	std::string_view spirvFragment;
+};
+
+/* Maps shaders.pack into memory with mmap. A Shader only reads from the pack while it's being
+ * constructed, so the pack can be closed once the shaders are created */
+class ShaderPack
+{
+private:
+	std::string m_FilePath;
+	const unsigned char* m_Data;
+	size_t m_Size;
+	const ShaderPackHeader* m_Header;
+	const ShaderPackEntry* m_Entries;
+public:
+	explicit ShaderPack(const std::string& filePath);
+	~ShaderPack();
+
+	ShaderPack(const ShaderPack&) = delete;
+	ShaderPack& operator=(const ShaderPack&) = delete;
+
+	inline bool isOpen() const { return m_Header != nullptr; }
+
+	/* false when the shader isn't in the pack */
+	bool find(std::string_view name, ShaderPackProgram& program) const;
+
+	/* which driver made the binaries. only use them if the current driver reports the same */
+	std::string_view getDriver() const;
+
+	static std::string getCurrentDriver();
+
+private:
+	std::string_view getString(uint32_t offset, uint32_t length) const;
+	bool validate() const;
+};
+
+
+#endif //OPENGL_THECHERNO_SHADERPACK_H
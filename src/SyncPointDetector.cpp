@@ -0,0 +1,191 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "SyncPointDetector.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct Site
+	{
+		const char* call;
+		const char* file;
+		int line;
+		GLCallKind kind;
+		uint64_t calls;
+		double totalMs;
+		double maxMs;
+	};
+
+	struct SiteKey
+	{
+		const char* file;
+		int line;
+
+		bool operator==(const SiteKey& other) const { return file == other.file && line == other.line; }
+	};
+
+	struct SiteKeyHash
+	{
+		size_t operator()(const SiteKey& key) const
+		{
+			return std::hash<const void*>()(key.file) ^ (static_cast<size_t>(key.line) * 0x9e3779b97f4a7c15ull);
+		}
+	};
+
+	/* like RenderStats, everything that calls opengl is on one thread, so nothing here is synchronised.
+	 * A call site is found by the address of its __FILE__ string and its line, which doesn't change */
+	std::unordered_map<SiteKey, Site, SiteKeyHash> sites;
+	SyncFrameStats current = {}, lastFrame = {}, total = {};
+	uint64_t frameCount = 0;
+	Clock::time_point callStart, errorCheckStart;
+
+	double millisecondsSince(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	void add(SyncFrameStats& to, const SyncFrameStats& from)
+	{
+		to.syncCalls += from.syncCalls;
+		to.asyncCalls += from.asyncCalls;
+		to.errorChecks += from.errorChecks;
+		to.syncMs += from.syncMs;
+		to.asyncMs += from.asyncMs;
+		to.errorCheckMs += from.errorCheckMs;
+	}
+
+	/* the first gl function called in the text, glMapBufferRange in "mapped = static_cast<...>(glMapBufferRange(...))" */
+	std::string_view getFunctionName(std::string_view call)
+	{
+		for(size_t i = 0; i + 2 < call.size(); i++)
+		{
+			const bool startsWord = i == 0 || !(std::isalnum(static_cast<unsigned char>(call[i - 1])) || call[i - 1] == '_');
+			if(!startsWord || call[i] != 'g' || call[i + 1] != 'l' || !std::isupper(static_cast<unsigned char>(call[i + 2])))
+				continue;
+			size_t end = i + 2;
+			while(end < call.size() && (std::isalnum(static_cast<unsigned char>(call[end])) || call[end] == '_'))
+				end++;
+			if(end < call.size() && call[end] == '(')
+				return call.substr(i, end - i);
+		}
+		return {};
+	}
+}
+
+GLCallKind SyncPointDetector::classify(std::string_view call)
+{
+	const std::string_view function = getFunctionName(call);
+	/* Everything that returns state (glGet*, glIs*, which includes glGetError and glGetUniformLocation),
+	 * reads pixels or buffers back, maps a buffer or waits for the gpu. Mapping with
+	 * GL_MAP_UNSYNCHRONIZED_BIT or reading into a pixel buffer don't wait for the gpu, but still for the
+	 * driver's thread if it has one */
+	constexpr std::string_view prefixes[] = {"glGet", "glIs", "glReadPixels", "glReadnPixels", "glMapBuffer", "glMapNamedBuffer"};
+	constexpr std::string_view functions[] = {"glFinish", "glClientWaitSync", "glUnmapBuffer", "glUnmapNamedBuffer",
+			"glCheckFramebufferStatus", "glCheckNamedFramebufferStatus", "glValidateProgram"};
+	for(std::string_view prefix : prefixes)
+	{
+		if(function.starts_with(prefix))
+			return GLCallKind::Synchronising;
+	}
+	for(std::string_view name : functions)
+	{
+		if(function == name)
+			return GLCallKind::Synchronising;
+	}
+	return GLCallKind::Async;
+}
+
+void SyncPointDetector::beginCall()
+{
+	callStart = Clock::now();
+}
+
+void SyncPointDetector::endCall(const char* call, const char* file, int line)
+{
+	const double ms = millisecondsSince(callStart);
+	auto [position, added] = sites.try_emplace({file, line});
+	Site& site = position->second;
+	if(added)
+		site = {call, file, line, classify(call), 0, 0.0, 0.0};
+	site.calls++;
+	site.totalMs += ms;
+	site.maxMs = std::max(site.maxMs, ms);
+
+	if(site.kind == GLCallKind::Synchronising)
+	{
+		current.syncCalls++;
+		current.syncMs += ms;
+	}
+	else
+	{
+		current.asyncCalls++;
+		current.asyncMs += ms;
+	}
+}
+
+void SyncPointDetector::beginErrorCheck()
+{
+	errorCheckStart = Clock::now();
+}
+
+void SyncPointDetector::endErrorCheck(unsigned int calls)
+{
+	current.errorChecks += calls;
+	current.errorCheckMs += millisecondsSince(errorCheckStart);
+}
+
+void SyncPointDetector::endFrame()
+{
+	lastFrame = current;
+	add(total, current);
+	frameCount++;
+	current = {};
+}
+
+const SyncFrameStats& SyncPointDetector::getLastFrame()
+{
+	return lastFrame;
+}
+
+void SyncPointDetector::printReport([[maybe_unused]] size_t maxSites)
+{
+#ifndef GL_SYNC_DIAGNOSTICS
+	std::cout << "SyncPointDetector: no calls were timed, configure with -DENABLE_GL_SYNC_DIAGNOSTICS=ON" << std::endl;
+#else
+	const double frames = static_cast<double>(std::max<uint64_t>(1, frameCount));
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "GL calls per frame over " << frameCount << " frames: " << static_cast<double>(total.syncCalls) / frames
+			  << " synchronising (" << total.syncMs / frames << " ms), " << static_cast<double>(total.asyncCalls) / frames
+			  << " async (" << total.asyncMs / frames << " ms), " << static_cast<double>(total.errorChecks) / frames
+			  << " glGetError of glCall (" << total.errorCheckMs / frames << " ms)" << std::endl;
+
+	std::vector<const Site*> synchronising;
+	for(const auto& [key, site] : sites)
+	{
+		if(site.kind == GLCallKind::Synchronising)
+			synchronising.push_back(&site);
+	}
+	std::sort(synchronising.begin(), synchronising.end(), [](const Site* a, const Site* b) { return a->totalMs > b->totalMs; });
+	if(synchronising.size() > maxSites)
+		synchronising.resize(maxSites);
+
+	std::cout << "       calls   per frame    total ms      max ms   synchronising call site" << std::endl;
+	for(const Site* site : synchronising)
+	{
+		std::cout << std::setw(12) << site->calls << std::setw(12) << static_cast<double>(site->calls) / frames
+				  << std::setw(12) << site->totalMs << std::setw(12) << site->maxMs << "   " << site->file << ":" << site->line
+				  << " " << getFunctionName(site->call) << std::endl;
+	}
+	std::cout << std::defaultfloat;
+#endif
+}
@@ -0,0 +1,59 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_SYNCPOINTDETECTOR_H
+#define OPENGL_THECHERNO_SYNCPOINTDETECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/* Most opengl calls only queue a command and return. The ones that hand something back to us, glGet*,
+ * glGetError, glGetUniformLocation, glReadPixels, mapping a buffer, waiting on a fence, may have to wait for
+ * the driver to catch up with everything queued before them, and with a threaded driver (Mesa's glthread,
+ * most Windows drivers) they always do. Those are the synchronising calls, in a frame every one is a
+ * possible stall.
+ *
+ * Built with -DENABLE_GL_SYNC_DIAGNOSTICS=ON (which defines GL_SYNC_DIAGNOSTICS) glCall times every call it
+ * wraps, and the glGetError checks around it, and counts them per call site and per frame. Calls that
+ * don't go through glCall aren't seen. Without the option glCall is as before and none of this runs */
+enum class GLCallKind
+{
+	Async,
+	Synchronising
+};
+
+struct SyncFrameStats
+{
+	uint64_t syncCalls;
+	uint64_t asyncCalls;
+	uint64_t errorChecks; // glGetError calls of glCall, two or more per call
+	double syncMs;
+	double asyncMs;
+	double errorCheckMs;
+};
+
+class SyncPointDetector
+{
+public:
+	/* by the opengl function in the text of a glCall, "location = glGetUniformLocation(...)" is synchronising */
+	static GLCallKind classify(std::string_view call);
+
+	/* glCall does these around the call */
+	static void beginCall();
+	static void endCall(const char* call, const char* file, int line);
+	/* and glClearError() and glLogCall() these around their glGetError loops */
+	static void beginErrorCheck();
+	static void endErrorCheck(unsigned int calls);
+
+	/* keeps the frame's numbers and starts the next one */
+	static void endFrame();
+	static const SyncFrameStats& getLastFrame();
+
+	/* per frame averages, then the call sites that spent the most time in synchronising calls */
+	static void printReport(size_t maxSites = 15);
+};
+
+
+#endif //OPENGL_THECHERNO_SYNCPOINTDETECTOR_H
@@ -3,44 +3,439 @@
 //
 
 #include "Texture.h"
-#include "vendor/stb_image/stb_image.h"
+#include "Image.h"
+#include "CompressedImage.h"
+#include "Mipmap.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "GLObjectRegistry.h"
+#include "Material.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
 
-Texture::Texture(const std::string& filePath)
-	: m_RendererID(0), m_FilePath(filePath),
-	m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
+namespace
 {
-	/* OpenGL's coordinates start from bottom left. As our texture stores data from top, we need to flip it*/
-	stbi_set_flip_vertically_on_load(1);
+	struct GLFormat
+	{
+		GLenum internalFormat;
+		GLenum format, type; // of the pixels we upload
+		size_t pixelSize; // in video memory
+		GLint swizzle[4];
+	};
 
-	/* Gets the texture data to our local buffer*/
-	m_LocalBuffer = stbi_load(filePath.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+	const GLFormat& getGLFormat(PixelFormat format)
+	{
+		static const GLFormat formats[] = {
+			{GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1, {GL_RED, GL_RED, GL_RED, GL_ONE}},
+			{GL_RG8, GL_RG, GL_UNSIGNED_BYTE, 2, {GL_RED, GL_RED, GL_RED, GL_GREEN}},
+			{GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, 3, {GL_RED, GL_GREEN, GL_BLUE, GL_ONE}},
+			{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA}},
+			// the floats are converted to half floats by the driver on the way in
+			{GL_R16F, GL_RED, GL_FLOAT, 2, {GL_RED, GL_RED, GL_RED, GL_ONE}},
+			{GL_RGBA16F, GL_RGBA, GL_FLOAT, 8, {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA}},
+			{GL_R32F, GL_RED, GL_FLOAT, 4, {GL_RED, GL_RED, GL_RED, GL_ONE}}
+		};
+		return formats[static_cast<int>(format)];
+	}
 
-	glCall(glGenTextures(1, &m_RendererID));
-	glCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	/* Rows are tightly packed, but opengl expects each of them to start at a multiple of 4 bytes.
+	 * A 3 wide RGB8 or R8 image has to say otherwise */
+	void setUnpackAlignment(size_t rowSize)
+	{
+		glCall(glPixelStorei(GL_UNPACK_ALIGNMENT, rowSize % 4 == 0 ? 4 : 1));
+	}
+}
 
-	/* these four are necessary to resize/clamp our texture. if we don't write these, we may see a black texture*/
-	glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-	glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-	glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-	glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+Texture::Texture(const std::string& filePath, std::source_location location)
+	: m_RendererID(0), m_FilePath(filePath), m_Width(0), m_Height(0), m_BPP(0), m_Levels(0), m_Format(PixelFormat::RGBA8), m_MemorySize(0), m_Placeholder(nullptr), m_Ready(false), m_Streamed(false), m_ResidentLevel(0), m_RequestedLevel(-1),
+	m_CreationSite(location)
+{
+	PROFILE_SCOPE("Texture::Texture");
+	if(CompressedImage::isCompressedFile(filePath))
+	{
+		upload(CompressedImage(filePath));
+		return;
+	}
 
+	/* Gets the texture data to our local buffer, with the channels the file has. The image frees it when it goes out of scope */
+	Image image(filePath, true);
+	upload(image);
+}
 
-	glCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
-	glCall(glBindTexture(GL_TEXTURE_2D, 0));
+Texture::Texture(const Image& image, std::source_location location)
+	: m_RendererID(0), m_Width(0), m_Height(0), m_BPP(0), m_Levels(0), m_Format(PixelFormat::RGBA8), m_MemorySize(0), m_Placeholder(nullptr), m_Ready(false), m_Streamed(false), m_ResidentLevel(0), m_RequestedLevel(-1),
+	m_CreationSite(location)
+{
+	PROFILE_SCOPE("Texture::Texture");
+	upload(image);
+}
 
-	if(m_LocalBuffer)
-		stbi_image_free(m_LocalBuffer);
+Texture::Texture(const CompressedImage& image, std::source_location location)
+	: m_RendererID(0), m_Width(0), m_Height(0), m_BPP(0), m_Levels(0), m_Format(PixelFormat::RGBA8), m_MemorySize(0), m_Placeholder(nullptr), m_Ready(false), m_Streamed(false), m_ResidentLevel(0), m_RequestedLevel(-1),
+	m_CreationSite(location)
+{
+	PROFILE_SCOPE("Texture::Texture");
+	upload(image);
+}
+
+Texture::Texture(std::string filePath, const Texture* placeholder, std::source_location location)
+	: m_RendererID(0), m_FilePath(std::move(filePath)), m_Width(0), m_Height(0), m_BPP(0), m_Levels(0), m_Format(PixelFormat::RGBA8), m_MemorySize(0), m_Placeholder(placeholder), m_Ready(false), m_Streamed(false), m_ResidentLevel(0), m_RequestedLevel(-1),
+	m_CreationSite(location)
+{
 }
 
 Texture::~Texture()
 {
+	GLObjectRegistry::remove(GLObjectType::Texture, m_RendererID);
 	glCall(glDeleteTextures(1, &m_RendererID));
+	MaterialBindState::forgetAll();
+}
+
+Texture::Texture(Texture&& other) noexcept
+	: m_RendererID(std::exchange(other.m_RendererID, 0)), m_FilePath(std::move(other.m_FilePath)), m_Width(other.m_Width),
+	m_Height(other.m_Height), m_BPP(other.m_BPP), m_Levels(other.m_Levels), m_Format(other.m_Format), m_MemorySize(other.m_MemorySize),
+	m_Sampler(other.m_Sampler), m_Placeholder(other.m_Placeholder), m_Ready(other.m_Ready), m_Streamed(other.m_Streamed),
+	m_ResidentLevel(other.m_ResidentLevel), m_RequestedLevel(other.m_RequestedLevel), m_CreationSite(other.m_CreationSite)
+{
+}
+
+/* the other one takes our texture object along and deletes it */
+Texture& Texture::operator=(Texture&& other) noexcept
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_FilePath, other.m_FilePath);
+	std::swap(m_Width, other.m_Width);
+	std::swap(m_Height, other.m_Height);
+	std::swap(m_BPP, other.m_BPP);
+	std::swap(m_Levels, other.m_Levels);
+	std::swap(m_Format, other.m_Format);
+	std::swap(m_MemorySize, other.m_MemorySize);
+	std::swap(m_Sampler, other.m_Sampler);
+	std::swap(m_Placeholder, other.m_Placeholder);
+	std::swap(m_Ready, other.m_Ready);
+	std::swap(m_Streamed, other.m_Streamed);
+	std::swap(m_ResidentLevel, other.m_ResidentLevel);
+	std::swap(m_RequestedLevel, other.m_RequestedLevel);
+	std::swap(m_CreationSite, other.m_CreationSite);
+	return *this;
+}
+
+void Texture::upload(const Image& image)
+{
+	m_BPP = image.getChannels();
+	allocate(image.getWidth(), image.getHeight(), 0, image.getFormat());
+	uploadRows(0, m_Height, image.getPixels());
+	generateMipmaps();
+	setReady();
+}
+
+void Texture::upload(const Image& image, const std::vector<Image>& mipLevels)
+{
+	m_BPP = image.getChannels();
+	allocate(image.getWidth(), image.getHeight(), 1 + static_cast<int>(mipLevels.size()), image.getFormat());
+	uploadRows(0, m_Height, image.getPixels());
+	for(size_t i = 0; i < mipLevels.size(); i++)
+		uploadRows(0, mipLevels[i].getHeight(), mipLevels[i].getPixels(), static_cast<int>(i) + 1);
+	setReady();
+}
+
+bool Texture::isFormatSupported(unsigned int compressedFormat)
+{
+	switch(compressedFormat)
+	{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			return GLEW_EXT_texture_compression_s3tc;
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+			return GLEW_EXT_texture_compression_s3tc && GLEW_EXT_texture_sRGB;
+		case GL_COMPRESSED_RED_RGTC1:
+		case GL_COMPRESSED_RG_RGTC2:
+			return GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc;
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+			return GLEW_ARB_texture_compression_bptc;
+	}
+	return false;
+}
+
+void Texture::upload(const CompressedImage& image)
+{
+	if(!image.isValid())
+		return;
+	if(!isFormatSupported(image.getFormat()))
+	{
+		std::cout << "Texture '" << m_FilePath << "': compressed format 0x" << std::hex << image.getFormat()
+				  << std::dec << " is not supported by this driver" << std::endl;
+		return;
+	}
+	int maxSize = 0;
+	glCall(glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize));
+	if(image.getWidth() > maxSize || image.getHeight() > maxSize)
+	{
+		std::cout << "Texture '" << m_FilePath << "' is " << image.getWidth() << "x" << image.getHeight()
+				  << ", this driver takes up to " << maxSize << std::endl;
+		return;
+	}
+
+	m_Width = image.getWidth();
+	m_Height = image.getHeight();
+	m_BPP = 0; // it's blocks, not pixels
+	m_Levels = static_cast<int>(image.getLevelCount());
+	m_MemorySize = image.getSize();
+	m_Streamed = false;
+
+	recreate();
+	/* the file brings its own mip levels. tell opengl how many there are, or it waits for levels that never come
+	 * and the texture is incomplete (black) */
+	glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_Levels - 1));
+	applySampler(GL_TEXTURE_2D, m_Sampler);
+
+	/* the blocks go to the gpu as they are, 4 to 8 times smaller than RGBA8 */
+	for(int level = 0; level < m_Levels; level++)
+	{
+		const CompressedLevel& info = image.getLevel(level);
+		glCall(glCompressedTexImage2D(GL_TEXTURE_2D, level, image.getFormat(), info.width, info.height, 0,
+				static_cast<int>(info.size), image.getLevelData(level)));
+	}
+	RenderStats::current().textureBytes += image.getSize();
+	glCall(glBindTexture(GL_TEXTURE_2D, 0));
+	setReady();
+}
+
+void Texture::allocate(int width, int height, int levels, PixelFormat format)
+{
+	m_Width = width;
+	m_Height = height;
+	m_Format = format;
+	const int fullChain = static_cast<int>(getMipLevelCount(width, height));
+	m_Levels = levels <= 0 ? fullChain : std::min(levels, fullChain);
+	m_MemorySize = 0;
+	for(int level = 0; level < m_Levels; level++)
+		m_MemorySize += getLevelSize(width, height, level, m_Format);
+	m_Streamed = false;
+
+	recreate();
+	glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_Levels - 1));
+	/* the filters are necessary, if we don't set them we may see a black texture */
+	applySampler(GL_TEXTURE_2D, m_Sampler);
+	applyFormat();
+
+	// no pixels yet, just the storage
+	const GLFormat& gl = getGLFormat(m_Format);
+	if(GLEW_ARB_texture_storage)
+	{
+		/* immutable: every level is made here at once, so the driver never has to check
+		 * if the texture is complete or move it when a level is added */
+		glCall(glTexStorage2D(GL_TEXTURE_2D, m_Levels, gl.internalFormat, m_Width, m_Height));
+	}
+	else
+	{
+		for(int level = 0; level < m_Levels; level++)
+		{
+			glCall(glTexImage2D(GL_TEXTURE_2D, level, gl.internalFormat, std::max(1, m_Width >> level), std::max(1, m_Height >> level),
+					0, gl.format, gl.type, nullptr));
+		}
+	}
+	glCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void Texture::allocateStreamed(int width, int height, PixelFormat format)
+{
+	m_Width = width;
+	m_Height = height;
+	m_Format = format;
+	m_BPP = static_cast<int>(getChannelCount(format));
+	m_Levels = static_cast<int>(getMipLevelCount(width, height));
+	m_MemorySize = 0;
+	m_Streamed = true;
+	m_ResidentLevel = m_Levels;
+
+	/* No glTexStorage2D here, immutable storage has every level in memory for good. The levels are
+	 * made one by one in streamLevel(), the ones below the base level don't count for completeness */
+	recreate();
+	glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, m_Levels - 1));
+	glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_Levels - 1));
+	applySampler(GL_TEXTURE_2D, m_Sampler);
+	applyFormat();
+	glCall(glBindTexture(GL_TEXTURE_2D, 0));
+	setReady();
+}
+
+void Texture::streamLevel(int level, const void* pixels)
+{
+	if(!m_Streamed || level != m_ResidentLevel - 1)
+	{
+		std::cout << "Texture '" << m_FilePath << "': level " << level << " can't be streamed in, the finest resident level is "
+				  << m_ResidentLevel << std::endl;
+		return;
+	}
+
+	const GLFormat& gl = getGLFormat(m_Format);
+	const int width = std::max(1, m_Width >> level);
+	bindForEditing(GL_TEXTURE_2D, m_RendererID);
+	setUnpackAlignment(width * getPixelSize(m_Format));
+	glCall(glTexImage2D(GL_TEXTURE_2D, level, gl.internalFormat, width, std::max(1, m_Height >> level),
+			0, gl.format, gl.type, pixels));
+	RenderStats::current().textureBytes += width * getPixelSize(m_Format) * std::max(1, m_Height >> level);
+	// only now, sampling never reaches a level that isn't there
+	glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level));
+	glCall(glBindTexture(GL_TEXTURE_2D, 0));
+	m_ResidentLevel = level;
+	m_MemorySize += getLevelSize(m_Width, m_Height, level, m_Format);
+	GLObjectRegistry::setSize(GLObjectType::Texture, m_RendererID, m_MemorySize);
+}
+
+void Texture::dropLevel()
+{
+	// the 1x1 level stays, or there'd be nothing to sample
+	if(!m_Streamed || m_ResidentLevel >= m_Levels - 1)
+		return;
+
+	const int level = m_ResidentLevel;
+	bindForEditing(GL_TEXTURE_2D, m_RendererID);
+	// first stop sampling the level, then a 0x0 image frees its memory
+	glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1));
+	const GLFormat& gl = getGLFormat(m_Format);
+	glCall(glTexImage2D(GL_TEXTURE_2D, level, gl.internalFormat, 0, 0, 0, gl.format, gl.type, nullptr));
+	glCall(glBindTexture(GL_TEXTURE_2D, 0));
+	m_ResidentLevel = level + 1;
+	m_MemorySize -= getLevelSize(m_Width, m_Height, level, m_Format);
+	GLObjectRegistry::setSize(GLObjectType::Texture, m_RendererID, m_MemorySize);
+}
+
+size_t Texture::getLevelSize(int width, int height, int level, PixelFormat format)
+{
+	return static_cast<size_t>(std::max(1, width >> level)) * std::max(1, height >> level) * getGLFormat(format).pixelSize;
+}
+
+void Texture::requestScreenSize(float width, float height) const
+{
+	if(m_Levels == 0)
+		return;
+	/* a level is enough when it has at most one texel per pixel. Each level halves the texels,
+	 * so the level is log2 of how many texels land on a pixel */
+	const float texelsPerPixel = std::max(m_Width / std::max(width, 1.0f), m_Height / std::max(height, 1.0f));
+	const int level = texelsPerPixel <= 1.0f ? 0 : std::min(static_cast<int>(std::log2(texelsPerPixel)), m_Levels - 1);
+	if(m_RequestedLevel < 0 || level < m_RequestedLevel)
+		m_RequestedLevel = level;
+}
+
+int Texture::takeRequestedLevel() const
+{
+	const int level = m_RequestedLevel;
+	m_RequestedLevel = -1;
+	return level;
+}
+
+void Texture::uploadRows(int firstRow, int rowCount, const void* pixels, int level)
+{
+	const GLFormat& gl = getGLFormat(m_Format);
+	const int width = std::max(1, m_Width >> level);
+	bindForEditing(GL_TEXTURE_2D, m_RendererID);
+	setUnpackAlignment(width * getPixelSize(m_Format));
+	glCall(glTexSubImage2D(GL_TEXTURE_2D, level, 0, firstRow, width, rowCount, gl.format, gl.type, pixels));
+	RenderStats::current().textureBytes += width * getPixelSize(m_Format) * rowCount;
+	glCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void Texture::uploadRegion(int x, int y, int width, int height, const void* pixels)
+{
+	const GLFormat& gl = getGLFormat(m_Format);
+	bindForEditing(GL_TEXTURE_2D, m_RendererID);
+	setUnpackAlignment(width * getPixelSize(m_Format));
+	glCall(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, gl.format, gl.type, pixels));
+	RenderStats::current().textureBytes += width * getPixelSize(m_Format) * height;
+	glCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void Texture::generateMipmaps()
+{
+	if(m_Levels <= 1)
+		return;
+	bindForEditing(GL_TEXTURE_2D, m_RendererID);
+	glCall(glGenerateMipmap(GL_TEXTURE_2D));
+	glCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void Texture::recreate()
+{
+	if(m_RendererID != 0)
+	{
+		GLObjectRegistry::remove(GLObjectType::Texture, m_RendererID);
+		glCall(glDeleteTextures(1, &m_RendererID));
+		MaterialBindState::forgetAll();
+	}
+	glCall(glGenTextures(1, &m_RendererID));
+	bindForEditing(GL_TEXTURE_2D, m_RendererID);
+	GLObjectRegistry::add(GLObjectType::Texture, m_RendererID, m_MemorySize, m_CreationSite);
+}
+
+void Texture::applyFormat() const
+{
+	glCall(glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, getGLFormat(m_Format).swizzle));
+}
+
+void Texture::setSampler(const TextureSampler& sampler)
+{
+	m_Sampler = sampler;
+	if(m_RendererID == 0)
+		return; // applied when the storage is made
+
+	bindForEditing(GL_TEXTURE_2D, m_RendererID);
+	applySampler(GL_TEXTURE_2D, m_Sampler);
+	glCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void Texture::applySampler(unsigned int target, const TextureSampler& sampler)
+{
+	GLenum minFilter = GL_LINEAR, magFilter = GL_LINEAR;
+	switch(sampler.filter)
+	{
+		case TextureFilter::Nearest:	minFilter = GL_NEAREST_MIPMAP_NEAREST; magFilter = GL_NEAREST; break;
+		case TextureFilter::Linear:		minFilter = GL_LINEAR; break;
+		case TextureFilter::Bilinear:	minFilter = GL_LINEAR_MIPMAP_NEAREST; break;
+		case TextureFilter::Trilinear:	minFilter = GL_LINEAR_MIPMAP_LINEAR; break;
+	}
+	glCall(glTexParameteri(target, GL_TEXTURE_MIN_FILTER, minFilter));
+	glCall(glTexParameteri(target, GL_TEXTURE_MAG_FILTER, magFilter));
+	glCall(glTexParameteri(target, GL_TEXTURE_WRAP_S, sampler.wrapS));
+	glCall(glTexParameteri(target, GL_TEXTURE_WRAP_T, sampler.wrapT));
+
+	if(GLEW_EXT_texture_filter_anisotropic)
+	{
+		float anisotropy = std::clamp(sampler.maxAnisotropy, 1.0f, getMaxSupportedAnisotropy());
+		glCall(glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy));
+	}
+}
+
+float Texture::getMaxSupportedAnisotropy()
+{
+	if(!GLEW_EXT_texture_filter_anisotropic)
+		return 1.0f;
+	static float maximum = 0.0f;
+	if(maximum == 0.0f)
+	{
+		glCall(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maximum));
+	}
+	return maximum;
+}
+
+void Texture::bindForEditing(unsigned int target, unsigned int texture)
+{
+	glCall(glActiveTexture(GL_TEXTURE0 + EditSlot));
+	glCall(glBindTexture(target, texture));
 }
 
 void Texture::bind(unsigned int slot) const
 {
+	RenderStats::current().textureBinds++;
 	glCall(glActiveTexture(GL_TEXTURE0 + slot));
-	glCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	glCall(glBindTexture(GL_TEXTURE_2D, getRendererID()));
 }
 
 void Texture::unBind() const
@@ -6,24 +6,150 @@
 #define OPENGL_THECHERNO_TEXTURE_H
 
 #include "Renderer.h"
+#include "Image.h"
+#include <source_location>
 #include <string>
+#include <vector>
+
+class CompressedImage;
+
+enum class TextureFilter
+{
+	Nearest, // blocky up close, picks the nearest mip level from far away
+	Linear, // no mip levels are sampled, sharp but sparkly when minified
+	Bilinear, // linear within the nearest mip level
+	Trilinear // linear between the two nearest mip levels
+};
+
+/* how a texture is sampled, see Texture::setSampler() */
+struct TextureSampler
+{
+	TextureFilter filter = TextureFilter::Trilinear;
+	unsigned int wrapS = GL_CLAMP_TO_EDGE;
+	unsigned int wrapT = GL_CLAMP_TO_EDGE;
+	/* Above 1 the texture is sampled more often along the direction it's squashed in, so floors and walls at
+	 * a steep angle stay sharp. Clamped to what the driver allows, ignored without anisotropic filtering */
+	float maxAnisotropy = 1.0f;
+};
 
 class Texture
 {
 private:
 	unsigned int m_RendererID;
 	std::string m_FilePath;
-	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP;
+	int m_Levels; // mip levels the storage has
+	PixelFormat m_Format; // of the pixels we take, not compressed textures
+	size_t m_MemorySize; // bytes of all levels
+	TextureSampler m_Sampler;
+	// bound in our place while we have no pixels yet (see TextureLoader)
+	const Texture* m_Placeholder;
+	// false while the pixels are still being streamed in, we bind the placeholder until then
+	bool m_Ready;
+	// made with allocateStreamed(): only the levels from m_ResidentLevel down are in video memory
+	bool m_Streamed;
+	int m_ResidentLevel;
+	// the finest level asked for with requestScreenSize() since the last takeRequestedLevel()
+	mutable int m_RequestedLevel;
+	// where we were made, the texture object is registered with it when it's made (see GLObjectRegistry)
+	std::source_location m_CreationSite;
 public:
-	Texture(const std::string& filePath);
+	/* .dds and .ktx2 files are uploaded as they are (block compressed), everything else goes through stb_image */
+	Texture(const std::string& filePath, std::source_location location = std::source_location::current());
+	explicit Texture(const Image& image, std::source_location location = std::source_location::current());
+	explicit Texture(const CompressedImage& image, std::source_location location = std::source_location::current());
+	/* a texture without pixels. it binds the placeholder (if any) until upload() is called */
+	Texture(std::string filePath, const Texture* placeholder, std::source_location location = std::source_location::current());
 	~Texture();
 
+	/* owns its texture object: moves, but a copy would delete it twice. Materials and textures waiting for
+	 * pixels point at the Texture, so don't move one that's in use */
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+	Texture(Texture&& other) noexcept;
+	Texture& operator=(Texture&& other) noexcept;
+
 	void bind(unsigned int slot = 0) const;
 	void unBind() const;
 
+	/* creates the opengl texture from the image, with a full mip chain from glGenerateMipmap.
+	 * The texture has the image's format, GL_R8 for a grey one, GL_RGBA16F for floats and so on. Whatever it
+	 * has, shaders see RGBA: grey is swizzled to all three colors and grey and alpha to color and alpha.
+	 * must be called on the thread that owns the context */
+	void upload(const Image& image);
+	/* the same with the mip levels made on the cpu (see generateMipChain()), level 1 first */
+	void upload(const Image& image, const std::vector<Image>& mipLevels);
+	/* uploads every level of the image with glCompressedTexImage2D. Does nothing (and says so)
+	 * if the driver doesn't support the format */
+	void upload(const CompressedImage& image);
+
+	static bool isFormatSupported(unsigned int compressedFormat);
+
+	/* For streaming the pixels in over several calls (see PixelUploadRing): allocate() makes the storage
+	 * for 'levels' mip levels (0 is the full chain) of pixels in format, uploadRows() fills rows of a level from the bottom up,
+	 * generateMipmaps() fills the levels below 0 from it, and setReady() stops binding the placeholder.
+	 * When a GL_PIXEL_UNPACK_BUFFER is bound, pixels is an offset into that buffer */
+	void allocate(int width, int height, int levels = 0, PixelFormat format = PixelFormat::RGBA8);
+	void uploadRows(int firstRow, int rowCount, const void* pixels, int level = 0);
+	/* a rectangle of level 0, x and y from the bottom left. pixels are width * height in the texture's format, bottom row first */
+	void uploadRegion(int x, int y, int width, int height, const void* pixels);
+	void generateMipmaps();
+	inline void setReady() { m_Ready = true; }
+
+	/* Mip streaming (see TextureStreamer): allocateStreamed() makes a texture with no levels in video memory.
+	 * streamLevel() adds the level above the finest one that's resident, so the levels come in from the 1x1
+	 * one up, and dropLevel() frees the finest one again. GL_TEXTURE_BASE_LEVEL is kept at the finest
+	 * resident level, so the texture can always be sampled once it has one */
+	void allocateStreamed(int width, int height, PixelFormat format = PixelFormat::RGBA8);
+	void streamLevel(int level, const void* pixels);
+	void dropLevel();
+	inline bool isStreamed() const { return m_Streamed; }
+	/* the finest level in video memory, getLevelCount() when there's none */
+	inline int getResidentLevel() const { return m_Streamed ? m_ResidentLevel : 0; }
+	/* bytes a level takes in video memory */
+	static size_t getLevelSize(int width, int height, int level, PixelFormat format = PixelFormat::RGBA8);
+
+	/* Called when something using the texture is drawn, with how many pixels wide and high it is on screen.
+	 * Keeps the finest level any draw needs until takeRequestedLevel() */
+	void requestScreenSize(float width, float height) const;
+	/* the finest level asked for, or -1 if the texture wasn't drawn. Starts over */
+	int takeRequestedLevel() const;
+
+	/* Applies right away and to any storage the texture gets later */
+	void setSampler(const TextureSampler& sampler);
+	inline const TextureSampler& getSampler() const { return m_Sampler; }
+	/* the largest maxAnisotropy the driver takes, 1 when it has no anisotropic filtering */
+	static float getMaxSupportedAnisotropy();
+	/* sets the sampler state of the texture bound to target (GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, ...) */
+	static void applySampler(unsigned int target, const TextureSampler& sampler);
+
+	/* The unit the upload and setup functions bind a texture on, above the slots materials bind to.
+	 * Uploading then never changes what's bound in a slot, which the renderer remembers between draws */
+	static constexpr unsigned int EditSlot = 16;
+	/* makes EditSlot the active unit and binds the texture there, for changing it (not for drawing) */
+	static void bindForEditing(unsigned int target, unsigned int texture);
+
+	inline void setPlaceholder(const Texture* placeholder) { m_Placeholder = placeholder; }
+
+	inline bool isLoaded() const { return m_Ready; }
+	/* the texture that bind() actually binds, the placeholder's while we are still loading */
+	inline unsigned int getRendererID() const
+	{
+		return m_Ready || !m_Placeholder ? m_RendererID : m_Placeholder->getRendererID();
+	}
+	inline const std::string& getFilePath() const { return m_FilePath; }
 	inline int getWidth() const { return m_Width;}
 	inline int getHeight() const { return m_Height;}
+	inline int getLevelCount() const { return m_Levels; }
+	inline PixelFormat getFormat() const { return m_Format; }
+	/* what the pixels take in video memory, roughly: the driver may pad or add its own */
+	inline size_t getMemorySize() const { return m_MemorySize; }
+
+private:
+	/* a new texture object, bound. Storage made with glTexStorage2D can't be made again, so any old one goes */
+	void recreate();
+	/* the storage format, swizzle included, for the texture bound to GL_TEXTURE_2D */
+	void applyFormat() const;
 };
 
 
@@ -0,0 +1,128 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "TextureArray.h"
+#include "Image.h"
+#include "Mipmap.h"
+#include "RenderStats.h"
+#include "GLObjectRegistry.h"
+#include "Material.h"
+#include <algorithm>
+#include <iostream>
+
+TextureArray::TextureArray(int width, int height, int layerCount, bool mipmaps, std::source_location location)
+	: m_RendererID(0), m_Width(width), m_Height(height), m_LayerCount(layerCount),
+	m_Levels(mipmaps ? static_cast<int>(getMipLevelCount(width, height)) : 1), m_Used(layerCount, false)
+{
+	GLint maxLayers = 0;
+	glCall(glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers));
+	if(layerCount > maxLayers)
+	{
+		std::cout << "TextureArray: " << layerCount << " layers asked for, the driver allows " << maxLayers << std::endl;
+		m_LayerCount = maxLayers;
+		m_Used.resize(maxLayers);
+	}
+
+	glCall(glGenTextures(1, &m_RendererID));
+	Texture::bindForEditing(GL_TEXTURE_2D_ARRAY, m_RendererID);
+	glCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, m_Levels - 1));
+	Texture::applySampler(GL_TEXTURE_2D_ARRAY, m_Sampler);
+
+	if(GLEW_ARB_texture_storage)
+	{
+		glCall(glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_Levels, GL_RGBA8, m_Width, m_Height, m_LayerCount));
+	}
+	else
+	{
+		for(int level = 0; level < m_Levels; level++)
+		{
+			glCall(glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, std::max(1, m_Width >> level), std::max(1, m_Height >> level),
+					m_LayerCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+		}
+	}
+	glCall(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+
+	size_t memorySize = 0;
+	for(int level = 0; level < m_Levels; level++)
+		memorySize += Texture::getLevelSize(m_Width, m_Height, level, PixelFormat::RGBA8) * m_LayerCount;
+	GLObjectRegistry::add(GLObjectType::TextureArray, m_RendererID, memorySize, location);
+}
+
+TextureArray::~TextureArray()
+{
+	GLObjectRegistry::remove(GLObjectType::TextureArray, m_RendererID);
+	glCall(glDeleteTextures(1, &m_RendererID));
+	MaterialBindState::forgetAll();
+}
+
+int TextureArray::addLayer(const Image& image)
+{
+	auto free = std::find(m_Used.begin(), m_Used.end(), false);
+	if(free == m_Used.end())
+		return -1;
+
+	int layer = static_cast<int>(free - m_Used.begin());
+	return setLayer(layer, image) ? layer : -1;
+}
+
+bool TextureArray::setLayer(int layer, const Image& image)
+{
+	if(m_Levels == 1)
+		return setLayer(layer, image, {});
+	return setLayer(layer, image, generateMipChain(image));
+}
+
+bool TextureArray::setLayer(int layer, const Image& image, const std::vector<Image>& mipLevels)
+{
+	if(layer < 0 || layer >= m_LayerCount || !image.isValid() || image.getFormat() != PixelFormat::RGBA8)
+		return false;
+	if(image.getWidth() != m_Width || image.getHeight() != m_Height)
+	{
+		std::cout << "TextureArray: a " << image.getWidth() << "x" << image.getHeight() << " image doesn't fit "
+				  << m_Width << "x" << m_Height << " layers" << std::endl;
+		return false;
+	}
+
+	Texture::bindForEditing(GL_TEXTURE_2D_ARRAY, m_RendererID);
+	glCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_Width, m_Height, 1, GL_RGBA, GL_UNSIGNED_BYTE, image.getPixels()));
+	RenderStats::current().textureBytes += image.getSize();
+	const int levels = std::min(m_Levels - 1, static_cast<int>(mipLevels.size()));
+	for(int level = 1; level <= levels; level++)
+	{
+		const Image& mip = mipLevels[level - 1];
+		glCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, mip.getWidth(), mip.getHeight(), 1,
+				GL_RGBA, GL_UNSIGNED_BYTE, mip.getPixels()));
+		RenderStats::current().textureBytes += mip.getSize();
+	}
+	glCall(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+
+	m_Used[layer] = true;
+	return true;
+}
+
+void TextureArray::removeLayer(int layer)
+{
+	if(layer >= 0 && layer < m_LayerCount)
+		m_Used[layer] = false;
+}
+
+void TextureArray::setSampler(const TextureSampler& sampler)
+{
+	m_Sampler = sampler;
+	Texture::bindForEditing(GL_TEXTURE_2D_ARRAY, m_RendererID);
+	Texture::applySampler(GL_TEXTURE_2D_ARRAY, m_Sampler);
+	glCall(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+}
+
+void TextureArray::bind(unsigned int slot) const
+{
+	RenderStats::current().textureBinds++;
+	glCall(glActiveTexture(GL_TEXTURE0 + slot));
+	glCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+}
+
+void TextureArray::unBind() const
+{
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
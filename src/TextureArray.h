@@ -0,0 +1,63 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_TEXTUREARRAY_H
+#define OPENGL_THECHERNO_TEXTUREARRAY_H
+
+#include <vector>
+#include "Texture.h"
+
+class Image;
+
+/* Many images of the same size in one GL_TEXTURE_2D_ARRAY, one image per layer. The shader samples it
+ * with a sampler2DArray and picks the layer with the third texture coordinate, which usually comes
+ * from a vertex attribute (see res/shaders/TextureArray.shader). Quads with different images can
+ * then be drawn together without binding anything in between.
+ *
+ * Layers are added and replaced one at a time with sub image uploads, the other layers are not touched.
+ * Each layer brings its own mip levels, made on the cpu (gamma correct) unless they are passed in, so
+ * replacing a layer doesn't regenerate the mips of all of them like glGenerateMipmap would.
+ * Must be used on the GL thread */
+class TextureArray
+{
+private:
+	unsigned int m_RendererID;
+	int m_Width, m_Height;
+	int m_LayerCount;
+	int m_Levels;
+	std::vector<bool> m_Used;
+	TextureSampler m_Sampler;
+public:
+	/* storage for layerCount layers of width x height, with a full mip chain if mipmaps is set */
+	TextureArray(int width, int height, int layerCount, bool mipmaps = true, std::source_location location = std::source_location::current());
+	~TextureArray();
+
+	TextureArray(const TextureArray&) = delete;
+	TextureArray& operator=(const TextureArray&) = delete;
+
+	/* Puts the image in the first free layer and returns its index, or -1 when every layer is used
+	 * or the image isn't width x height RGBA8 */
+	int addLayer(const Image& image);
+	/* replaces the layer's pixels. mipLevels, level 1 first (see generateMipChain()), saves making them here */
+	bool setLayer(int layer, const Image& image);
+	bool setLayer(int layer, const Image& image, const std::vector<Image>& mipLevels);
+	/* lets addLayer() hand the layer out again, the pixels stay until then */
+	void removeLayer(int layer);
+
+	void setSampler(const TextureSampler& sampler);
+	inline const TextureSampler& getSampler() const { return m_Sampler; }
+
+	void bind(unsigned int slot = 0) const;
+	void unBind() const;
+
+	inline unsigned int getRendererID() const { return m_RendererID; }
+	inline int getWidth() const { return m_Width; }
+	inline int getHeight() const { return m_Height; }
+	inline int getLayerCount() const { return m_LayerCount; }
+	inline int getLevelCount() const { return m_Levels; }
+	inline bool isLayerUsed(int layer) const { return m_Used[layer]; }
+};
+
+
+#endif //OPENGL_THECHERNO_TEXTUREARRAY_H
@@ -0,0 +1,279 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "TextureAtlas.h"
+#include "Image.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace
+{
+	inline bool intersects(const AtlasRect& a, const AtlasRect& b)
+	{
+		return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+	}
+
+	inline bool contains(const AtlasRect& outer, const AtlasRect& inner)
+	{
+		return inner.x >= outer.x && inner.y >= outer.y
+			&& inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+	}
+}
+
+MaxRectsPacker::MaxRectsPacker(int width, int height)
+	: m_Width(width), m_Height(height), m_Stale(false)
+{
+	clear();
+}
+
+void MaxRectsPacker::clear()
+{
+	m_Used.clear();
+	m_Free.assign(1, {0, 0, m_Width, m_Height});
+	m_Stale = false;
+}
+
+bool MaxRectsPacker::insert(int width, int height, AtlasRect& placed)
+{
+	if(m_Stale)
+	{
+		/* Handing removed rectangles back as free ones would leave the free space in pieces that don't
+		 * know about each other. Cutting everything still in use out of the empty bin again gives the
+		 * maximal ones, and doing it here pays for a whole burst of removes at once */
+		m_Free.assign(1, {0, 0, m_Width, m_Height});
+		for(const AtlasRect& used : m_Used)
+			place(used);
+		m_Stale = false;
+	}
+
+	int bestShortSide = INT_MAX, bestLongSide = INT_MAX;
+	const AtlasRect* best = nullptr;
+	for(const AtlasRect& free : m_Free)
+	{
+		if(free.width < width || free.height < height)
+			continue;
+
+		int leftoverX = free.width - width, leftoverY = free.height - height;
+		int shortSide = std::min(leftoverX, leftoverY), longSide = std::max(leftoverX, leftoverY);
+		if(shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+		{
+			best = &free;
+			bestShortSide = shortSide;
+			bestLongSide = longSide;
+		}
+	}
+	if(!best)
+		return false;
+
+	placed = {best->x, best->y, width, height};
+	place(placed);
+	m_Used.push_back(placed);
+	return true;
+}
+
+void MaxRectsPacker::remove(const AtlasRect& rect)
+{
+	auto it = std::find_if(m_Used.begin(), m_Used.end(), [&rect](const AtlasRect& used) {
+		return used.x == rect.x && used.y == rect.y && used.width == rect.width && used.height == rect.height;
+	});
+	if(it == m_Used.end())
+		return;
+	m_Used.erase(it);
+	m_Stale = true;
+}
+
+void MaxRectsPacker::restore(const AtlasRect& rect)
+{
+	m_Used.push_back(rect);
+	m_Stale = true;
+}
+
+void MaxRectsPacker::place(const AtlasRect& used)
+{
+	/* every free rectangle the new one overlaps is replaced by the (up to 4) parts of it around the new one */
+	std::vector<AtlasRect> split;
+	for(size_t i = 0; i < m_Free.size();)
+	{
+		const AtlasRect free = m_Free[i];
+		if(!intersects(free, used))
+		{
+			i++;
+			continue;
+		}
+		m_Free[i] = m_Free.back();
+		m_Free.pop_back();
+
+		if(used.x > free.x)
+			split.push_back({free.x, free.y, used.x - free.x, free.height});
+		if(used.x + used.width < free.x + free.width)
+			split.push_back({used.x + used.width, free.y, free.x + free.width - used.x - used.width, free.height});
+		if(used.y > free.y)
+			split.push_back({free.x, free.y, free.width, used.y - free.y});
+		if(used.y + used.height < free.y + free.height)
+			split.push_back({free.x, used.y + used.height, free.width, free.y + free.height - used.y - used.height});
+	}
+
+	/* A free rectangle inside another one is never the better choice. The old ones were already pruned
+	 * against each other, so only the new ones need checking */
+	for(size_t i = 0; i < split.size(); i++)
+	{
+		bool redundant = false;
+		for(size_t j = 0; j < split.size() && !redundant; j++)
+			redundant = j != i && contains(split[j], split[i]) && (!contains(split[i], split[j]) || j < i);
+		for(size_t j = 0; j < m_Free.size() && !redundant; j++)
+			redundant = contains(m_Free[j], split[i]);
+		if(redundant)
+			continue;
+
+		m_Free.erase(std::remove_if(m_Free.begin(), m_Free.end(), [&](const AtlasRect& free) {
+			return contains(split[i], free);
+		}), m_Free.end());
+		m_Free.push_back(split[i]);
+	}
+}
+
+float MaxRectsPacker::getOccupancy() const
+{
+	long long area = 0;
+	for(const AtlasRect& used : m_Used)
+		area += static_cast<long long>(used.width) * used.height;
+	return static_cast<float>(area) / (static_cast<float>(m_Width) * static_cast<float>(m_Height));
+}
+
+TextureAtlas::TextureAtlas(int pageSize, int padding, unsigned int maxPages, bool bleed)
+	: m_PageSize(pageSize), m_Padding(padding), m_MaxPages(maxPages), m_Bleed(bleed)
+{
+}
+
+TextureAtlas::Page& TextureAtlas::addPage()
+{
+	auto texture = std::make_unique<Texture>("atlas page " + std::to_string(m_Pages.size()), nullptr);
+	texture->setSampler(m_Sampler);
+	texture->allocate(m_PageSize, m_PageSize);
+
+	// the storage starts out undefined, clear it so the padding of the first images isn't garbage
+	std::vector<unsigned char> transparent(static_cast<size_t>(m_PageSize) * m_PageSize * 4, 0);
+	texture->uploadRows(0, m_PageSize, transparent.data());
+	texture->setReady();
+
+	m_Pages.push_back({std::move(texture), MaxRectsPacker(m_PageSize, m_PageSize), true});
+	return m_Pages.back();
+}
+
+const AtlasRegion* TextureAtlas::add(const std::string& name, const Image& image)
+{
+	if(!image.isValid() || image.getFormat() != PixelFormat::RGBA8)
+		return nullptr;
+	const int width = image.getWidth() + 2 * m_Padding, height = image.getHeight() + 2 * m_Padding;
+	if(width > m_PageSize || height > m_PageSize)
+		return nullptr;
+
+	/* a replaced image gives its space up first, the new one may well fit where it was. If it fits
+	 * nowhere, the old one gets its space back and stays */
+	auto existing = m_Regions.find(name);
+	if(existing != m_Regions.end())
+		m_Pages[existing->second.page].packer.remove(getPaddedRect(existing->second));
+
+	AtlasRect rect{};
+	unsigned int page = 0;
+	for(; page < m_Pages.size(); page++)
+	{
+		if(m_Pages[page].packer.insert(width, height, rect))
+			break;
+	}
+	if(page == m_Pages.size())
+	{
+		if(m_Pages.size() >= m_MaxPages)
+		{
+			if(existing != m_Regions.end())
+				m_Pages[existing->second.page].packer.restore(getPaddedRect(existing->second));
+			return nullptr;
+		}
+		addPage().packer.insert(width, height, rect);
+	}
+
+	upload(m_Pages[page], rect, image);
+
+	AtlasRegion region;
+	region.page = page;
+	region.rect = {rect.x + m_Padding, rect.y + m_Padding, image.getWidth(), image.getHeight()};
+	const float size = static_cast<float>(m_PageSize);
+	region.u0 = static_cast<float>(region.rect.x) / size;
+	region.v0 = static_cast<float>(region.rect.y) / size;
+	region.u1 = static_cast<float>(region.rect.x + region.rect.width) / size;
+	region.v1 = static_cast<float>(region.rect.y + region.rect.height) / size;
+	return &(m_Regions[name] = region);
+}
+
+void TextureAtlas::upload(Page& page, const AtlasRect& rect, const Image& image)
+{
+	/* the image with its padding around it. With bleed the padding repeats the nearest edge pixel,
+	 * without it it's transparent */
+	const int width = rect.width, height = rect.height;
+	std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4, 0);
+	for(int y = 0; y < height; y++)
+	{
+		int sourceY = y - m_Padding;
+		bool insideY = sourceY >= 0 && sourceY < image.getHeight();
+		if(!insideY && !m_Bleed)
+			continue;
+		sourceY = std::clamp(sourceY, 0, image.getHeight() - 1);
+
+		const unsigned char* source = image.getPixels() + static_cast<size_t>(sourceY) * image.getWidth() * 4;
+		unsigned char* target = pixels.data() + static_cast<size_t>(y) * width * 4;
+		std::memcpy(target + m_Padding * 4, source, static_cast<size_t>(image.getWidth()) * 4);
+		if(m_Bleed)
+		{
+			for(int x = 0; x < m_Padding; x++)
+			{
+				std::memcpy(target + x * 4, source, 4);
+				std::memcpy(target + (m_Padding + image.getWidth() + x) * 4, source + (image.getWidth() - 1) * 4, 4);
+			}
+		}
+	}
+
+	page.texture->uploadRegion(rect.x, rect.y, width, height, pixels.data());
+	page.dirty = true;
+}
+
+bool TextureAtlas::remove(const std::string& name)
+{
+	auto it = m_Regions.find(name);
+	if(it == m_Regions.end())
+		return false;
+
+	m_Pages[it->second.page].packer.remove(getPaddedRect(it->second));
+	m_Regions.erase(it);
+	return true;
+}
+
+AtlasRect TextureAtlas::getPaddedRect(const AtlasRegion& region) const
+{
+	return {region.rect.x - m_Padding, region.rect.y - m_Padding, region.rect.width + 2 * m_Padding, region.rect.height + 2 * m_Padding};
+}
+
+const AtlasRegion* TextureAtlas::find(const std::string& name) const
+{
+	auto it = m_Regions.find(name);
+	return it == m_Regions.end() ? nullptr : &it->second;
+}
+
+void TextureAtlas::update()
+{
+	for(Page& page : m_Pages)
+	{
+		if(!page.dirty)
+			continue;
+		page.texture->generateMipmaps();
+		page.dirty = false;
+	}
+}
+
+void TextureAtlas::setSampler(const TextureSampler& sampler)
+{
+	m_Sampler = sampler;
+	for(Page& page : m_Pages)
+		page.texture->setSampler(sampler);
+}
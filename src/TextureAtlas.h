@@ -0,0 +1,121 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_TEXTUREATLAS_H
+#define OPENGL_THECHERNO_TEXTUREATLAS_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Texture.h"
+
+class Image;
+
+struct AtlasRect
+{
+	int x, y, width, height;
+};
+
+/* Places rectangles in a fixed size bin with the MaxRects algorithm: it keeps every maximal free rectangle
+ * (they overlap each other), puts a new rectangle in the free one it fits most snugly (best short side fit)
+ * and then cuts that space out of all the free rectangles it touches. No opengl, just the bookkeeping.
+ *
+ * Space given back with remove() is found again by rebuilding the free rectangles from the ones still
+ * in use on the next insert(), so a bin that had things taken out of it packs as well as a fresh one */
+class MaxRectsPacker
+{
+private:
+	int m_Width, m_Height;
+	std::vector<AtlasRect> m_Free;
+	std::vector<AtlasRect> m_Used;
+	bool m_Stale; // something was removed, m_Free doesn't have its space yet
+public:
+	MaxRectsPacker(int width, int height);
+
+	/* false when it doesn't fit anywhere */
+	bool insert(int width, int height, AtlasRect& placed);
+	/* rect must be one insert() gave back */
+	void remove(const AtlasRect& rect);
+	/* takes a removed rect back where it was. Nothing else may have been inserted since the remove() */
+	void restore(const AtlasRect& rect);
+	void clear();
+
+	/* used area over the whole bin, 0 to 1 */
+	float getOccupancy() const;
+	inline int getWidth() const { return m_Width; }
+	inline int getHeight() const { return m_Height; }
+private:
+	void place(const AtlasRect& used);
+};
+
+/* where an image ended up in the atlas */
+struct AtlasRegion
+{
+	unsigned int page; // which texture, see TextureAtlas::getPage()
+	AtlasRect rect; // in texels without the padding, from the bottom left
+	float u0, v0, u1, v1; // texture coordinates of the corners, bottom left and top right
+};
+
+/* Combines many images into a few big textures (pages), so quads with different images can share
+ * one bind and one batch.
+ *
+ * Every image gets 'padding' texels around it. The padding is filled by repeating the image's edge
+ * (bleed), so linear filtering and the first mip levels don't pull in the neighbours' colors.
+ * About log2(padding) + 1 mip levels stay clean, with 2 texels minification up to 4x looks right.
+ *
+ * Images can be added and removed at any time, for content that comes and goes. add() uploads the
+ * pixels right away, but the mip levels only follow in update(), call it once after a batch of adds.
+ * Everything here must be called on the GL thread */
+class TextureAtlas
+{
+private:
+	struct Page
+	{
+		std::unique_ptr<Texture> texture;
+		MaxRectsPacker packer;
+		bool dirty; // the mip levels are out of date
+	};
+
+	int m_PageSize;
+	int m_Padding;
+	unsigned int m_MaxPages;
+	bool m_Bleed;
+	TextureSampler m_Sampler;
+	std::vector<Page> m_Pages;
+	std::unordered_map<std::string, AtlasRegion> m_Regions;
+public:
+	explicit TextureAtlas(int pageSize = 2048, int padding = 2, unsigned int maxPages = 4, bool bleed = true);
+
+	TextureAtlas(const TextureAtlas&) = delete;
+	TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+	/* Puts the image in the first page with room, or a new page while there are fewer than maxPages.
+	 * A name that is already there is replaced, or kept as it was when the new image has no room.
+	 * Returns nullptr when nothing has room or the image is bigger than a page or not RGBA8.
+	 * The pointer stays valid until the name is removed */
+	const AtlasRegion* add(const std::string& name, const Image& image);
+	/* frees the space for other images. false if there was no such name */
+	bool remove(const std::string& name);
+	const AtlasRegion* find(const std::string& name) const;
+
+	/* regenerates the mip levels of the pages that changed since the last call */
+	void update();
+
+	/* for every page, the ones made later too */
+	void setSampler(const TextureSampler& sampler);
+
+	inline unsigned int getPageCount() const { return static_cast<unsigned int>(m_Pages.size()); }
+	inline const Texture& getPage(unsigned int page) const { return *m_Pages[page].texture; }
+	inline float getOccupancy(unsigned int page) const { return m_Pages[page].packer.getOccupancy(); }
+	inline size_t getRegionCount() const { return m_Regions.size(); }
+private:
+	Page& addPage();
+	/* the padded rectangle the region takes in its page */
+	AtlasRect getPaddedRect(const AtlasRegion& region) const;
+	void upload(Page& page, const AtlasRect& rect, const Image& image);
+};
+
+
+#endif //OPENGL_THECHERNO_TEXTUREATLAS_H
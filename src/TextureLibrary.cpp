@@ -0,0 +1,207 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "TextureLibrary.h"
+#include "CompressedImage.h"
+#include "Image.h"
+#include "TextureLoader.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+	/* FNV-1a, 64 bits so that different files don't share a hash in practice */
+	uint64_t hashBytes(const unsigned char* data, size_t size, uint64_t hash = 14695981039346656037ull)
+	{
+		for(size_t i = 0; i < size; i++)
+		{
+			hash ^= data[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	bool hashFile(const std::string& filePath, uint64_t& hash)
+	{
+		std::ifstream file(filePath, std::ios::binary);
+		if(!file)
+			return false;
+		std::vector<unsigned char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		hash = hashBytes(contents.data(), contents.size());
+		return true;
+	}
+}
+
+TextureLibrary::TextureLibrary(size_t budget, TextureLoader* loader)
+	: m_Budget(budget), m_Loader(loader), m_Self(std::make_shared<TextureLibrary*>(this)),
+	m_Hits(0), m_Misses(0), m_Evictions(0)
+{
+}
+
+TextureLibrary::~TextureLibrary()
+{
+	// handles that are still out keep their textures, they just don't report back any more
+	m_Self.reset();
+}
+
+std::shared_ptr<Texture> TextureLibrary::acquire(const std::string& filePath)
+{
+	auto path = m_Paths.find(filePath);
+	if(path != m_Paths.end())
+	{
+		m_Hits++;
+		return makeHandle(*path->second);
+	}
+
+	uint64_t contentHash;
+	if(!hashFile(filePath, contentHash))
+	{
+		std::cout << "TextureLibrary: can't read '" << filePath << "'" << std::endl;
+		return nullptr;
+	}
+
+	auto entry = m_Entries.find(contentHash);
+	if(entry != m_Entries.end())
+	{
+		// the same file under another name
+		m_Hits++;
+		entry->second->paths.push_back(filePath);
+		m_Paths[filePath] = entry->second.get();
+		return makeHandle(*entry->second);
+	}
+
+	m_Misses++;
+	std::shared_ptr<Texture> texture = m_Loader ? m_Loader->load(filePath) : std::make_shared<Texture>(filePath);
+	return insert(contentHash, filePath, std::move(texture));
+}
+
+std::shared_ptr<Texture> TextureLibrary::acquire(const std::string& name, const Image& image)
+{
+	auto path = m_Paths.find(name);
+	if(path != m_Paths.end())
+	{
+		m_Hits++;
+		return makeHandle(*path->second);
+	}
+
+	// the size and format go in too, the same bytes can be a 4x2 or a 2x4 image, or 8x4 grey pixels
+	const int size[] = {image.getWidth(), image.getHeight(), static_cast<int>(image.getFormat())};
+	uint64_t contentHash = hashBytes(reinterpret_cast<const unsigned char*>(size), sizeof(size));
+	contentHash = hashBytes(image.getPixels(), image.getSize(), contentHash);
+
+	auto entry = m_Entries.find(contentHash);
+	if(entry != m_Entries.end())
+	{
+		m_Hits++;
+		entry->second->paths.push_back(name);
+		m_Paths[name] = entry->second.get();
+		return makeHandle(*entry->second);
+	}
+
+	m_Misses++;
+	return insert(contentHash, name, std::make_shared<Texture>(image));
+}
+
+std::shared_ptr<Texture> TextureLibrary::insert(uint64_t contentHash, const std::string& path, std::shared_ptr<Texture> texture)
+{
+	auto entry = std::make_unique<Entry>();
+	entry->texture = std::move(texture);
+	entry->contentHash = contentHash;
+	entry->paths.push_back(path);
+	entry->unused = false;
+
+	Entry& inserted = *entry;
+	m_Entries[contentHash] = std::move(entry);
+	m_Paths[path] = &inserted;
+
+	std::shared_ptr<Texture> handle = makeHandle(inserted);
+	trim();
+	return handle;
+}
+
+std::shared_ptr<Texture> TextureLibrary::makeHandle(Entry& entry)
+{
+	if(std::shared_ptr<Texture> handle = entry.handle.lock())
+		return handle;
+
+	if(entry.unused)
+	{
+		m_Unused.erase(entry.unusedPosition);
+		entry.unused = false;
+	}
+
+	/* All the handles of an entry share this one reference count. The deleter doesn't delete, it
+	 * tells the library that nobody uses the texture any more, and keeps the texture alive in case
+	 * the library is gone by then */
+	std::weak_ptr<TextureLibrary*> library = m_Self;
+	std::shared_ptr<Texture> keepAlive = entry.texture;
+	const uint64_t contentHash = entry.contentHash;
+	std::shared_ptr<Texture> handle(entry.texture.get(), [library, keepAlive, contentHash](Texture*) {
+		if(std::shared_ptr<TextureLibrary*> self = library.lock())
+			(*self)->release(contentHash);
+	});
+	entry.handle = handle;
+	return handle;
+}
+
+void TextureLibrary::release(uint64_t contentHash)
+{
+	auto it = m_Entries.find(contentHash);
+	if(it == m_Entries.end())
+		return;
+
+	Entry& entry = *it->second;
+	entry.unused = true;
+	entry.unusedPosition = m_Unused.insert(m_Unused.end(), &entry);
+	trim();
+}
+
+void TextureLibrary::setBudget(size_t budget)
+{
+	m_Budget = budget;
+	trim();
+}
+
+void TextureLibrary::trim()
+{
+	size_t usage = getMemoryUsage();
+	while(usage > m_Budget && !m_Unused.empty())
+	{
+		Entry& oldest = *m_Unused.front();
+		usage -= oldest.texture->getMemorySize();
+		evict(oldest);
+	}
+}
+
+void TextureLibrary::clearUnused()
+{
+	while(!m_Unused.empty())
+		evict(*m_Unused.front());
+}
+
+void TextureLibrary::evict(Entry& entry)
+{
+	m_Unused.erase(entry.unusedPosition);
+	for(const std::string& path : entry.paths)
+		m_Paths.erase(path);
+	m_Evictions++;
+	m_Entries.erase(entry.contentHash); // deletes the texture
+}
+
+size_t TextureLibrary::getMemoryUsage() const
+{
+	size_t usage = 0;
+	for(const auto& [hash, entry] : m_Entries)
+		usage += entry->texture->getMemorySize();
+	return usage;
+}
+
+void TextureLibrary::printStats() const
+{
+	std::cout << "TextureLibrary: " << m_Entries.size() << " textures (" << m_Unused.size() << " unused), "
+			  << getMemoryUsage() / 1024 << " of " << m_Budget / 1024 << " KB, "
+			  << m_Hits << " hits, " << m_Misses << " loads, " << m_Evictions << " evicted" << std::endl;
+}
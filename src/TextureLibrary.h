@@ -0,0 +1,88 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_TEXTURELIBRARY_H
+#define OPENGL_THECHERNO_TEXTURELIBRARY_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "Texture.h"
+
+class Image;
+class TextureLoader;
+
+/* Hands out shared textures, so every asset is loaded, decoded and uploaded once.
+ *
+ * A texture is found by its path, and when the path is new, by the hash of the file's contents:
+ * two copies of the same file under different names share one GL texture. Reading and hashing the
+ * file is cheap next to decoding and uploading it.
+ *
+ * The handles are shared_ptrs. When the last one goes away the texture isn't deleted but kept as
+ * unused, and acquiring it again is free. Unused textures are deleted oldest first whenever the
+ * textures together take more video memory than the budget. Textures in use are never deleted,
+ * so the budget can be overrun when everything is in use.
+ *
+ * With a TextureLoader the textures load in the background (see TextureLoader::load()), otherwise
+ * they're loaded right away. Must be used on the GL thread. Handles may outlive the library, their
+ * textures are deleted with the last one then */
+class TextureLibrary
+{
+private:
+	struct Entry
+	{
+		std::shared_ptr<Texture> texture; // the library's own reference
+		std::weak_ptr<Texture> handle; // what acquire() gave out, while any of it is still alive
+		uint64_t contentHash;
+		std::vector<std::string> paths; // every name this content was acquired under
+		bool unused;
+		std::list<Entry*>::iterator unusedPosition; // in m_Unused while unused
+	};
+
+	std::unordered_map<uint64_t, std::unique_ptr<Entry>> m_Entries; // by content hash
+	std::unordered_map<std::string, Entry*> m_Paths;
+	std::list<Entry*> m_Unused; // least recently used first
+	size_t m_Budget;
+	TextureLoader* m_Loader;
+	// the handles hold a weak reference, so they know if they may still call back
+	std::shared_ptr<TextureLibrary*> m_Self;
+
+	size_t m_Hits, m_Misses, m_Evictions;
+public:
+	/* budget in bytes of video memory */
+	explicit TextureLibrary(size_t budget = 256 * 1024 * 1024, TextureLoader* loader = nullptr);
+	~TextureLibrary();
+
+	TextureLibrary(const TextureLibrary&) = delete;
+	TextureLibrary& operator=(const TextureLibrary&) = delete;
+
+	/* the texture of the file, loaded only if neither the path nor its contents were seen before.
+	 * nullptr if the file can't be read */
+	std::shared_ptr<Texture> acquire(const std::string& filePath);
+	/* for images made at runtime: the same pixels under any name give the same texture */
+	std::shared_ptr<Texture> acquire(const std::string& name, const Image& image);
+
+	void setBudget(size_t budget);
+	/* deletes unused textures, oldest first, until the total is within the budget */
+	void trim();
+	/* deletes every unused texture */
+	void clearUnused();
+
+	/* bytes of video memory all the textures take, the unused ones included */
+	size_t getMemoryUsage() const;
+	inline size_t getBudget() const { return m_Budget; }
+	inline size_t getTextureCount() const { return m_Entries.size(); }
+	inline size_t getUnusedCount() const { return m_Unused.size(); }
+	void printStats() const;
+private:
+	std::shared_ptr<Texture> makeHandle(Entry& entry);
+	std::shared_ptr<Texture> insert(uint64_t contentHash, const std::string& path, std::shared_ptr<Texture> texture);
+	void release(uint64_t contentHash);
+	void evict(Entry& entry);
+};
+
+
+#endif //OPENGL_THECHERNO_TEXTURELIBRARY_H
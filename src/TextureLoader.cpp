@@ -0,0 +1,239 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "TextureLoader.h"
+#include "BlockCompression.h"
+#include "Mipmap.h"
+#include "PixelUploadRing.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+static double nowMs()
+{
+	using namespace std::chrono;
+	return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+static Image makePlaceholderImage()
+{
+	// a single grey pixel, so that a quad waiting for its texture doesn't look broken
+	Image image(1, 1);
+	const unsigned char grey[] = {128, 128, 128, 255};
+	std::memcpy(image.getPixels(), grey, sizeof(grey));
+	return image;
+}
+
+TextureLoader::TextureLoader(unsigned int workerCount)
+	: m_Decoding(0), m_Stopping(false), m_CompressOnLoad(false), m_Placeholder(makePlaceholderImage()),
+	m_UploadRing(nullptr), m_RingBytesPerFrame(0)
+{
+	if(workerCount == 0)
+		workerCount = std::max(1u, std::thread::hardware_concurrency() - 1);
+
+	for(unsigned int i = 0; i < workerCount; i++)
+		m_Workers.emplace_back(&TextureLoader::workerLoop, this);
+}
+
+TextureLoader::~TextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_WorkAvailable.notify_all();
+	for(std::thread& worker : m_Workers)
+		worker.join();
+
+	/* textures that never got their pixels would be left pointing at our placeholder */
+	for(Request& request : m_Queued)
+		request.texture->setPlaceholder(nullptr);
+	for(Request& request : m_Decoded)
+		request.texture->setPlaceholder(nullptr);
+	// their onComplete would call back into us
+	for(const std::shared_ptr<Texture>& texture : m_Streaming)
+	{
+		m_UploadRing->cancel(*texture);
+		texture->setPlaceholder(nullptr);
+	}
+	for(const std::weak_ptr<Texture>& failed : m_Failed)
+	{
+		if(std::shared_ptr<Texture> texture = failed.lock())
+			texture->setPlaceholder(nullptr);
+	}
+}
+
+std::shared_ptr<Texture> TextureLoader::load(const std::string& filePath)
+{
+	auto texture = std::make_shared<Texture>(filePath, &m_Placeholder);
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Queued.push_back({texture, Image(), CompressedImage(), nowMs(), 0.0, 0.0});
+	}
+	m_WorkAvailable.notify_one();
+	return texture;
+}
+
+void TextureLoader::setUploadRing(PixelUploadRing* ring, size_t bytesPerFrame)
+{
+	m_UploadRing = ring;
+	m_RingBytesPerFrame = bytesPerFrame;
+}
+
+bool TextureLoader::setCompressOnLoad(bool compress)
+{
+	if(compress && !(Texture::isFormatSupported(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT)
+			&& Texture::isFormatSupported(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)))
+	{
+		std::cout << "TextureLoader: the driver has no BC1/BC3 support, textures load uncompressed" << std::endl;
+		compress = false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_CompressOnLoad = compress;
+	return compress;
+}
+
+void TextureLoader::workerLoop()
+{
+	PROFILE_THREAD("TextureLoader worker");
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while(true)
+	{
+		m_WorkAvailable.wait(lock, [this]() { return m_Stopping || !m_Queued.empty(); });
+		if(m_Stopping)
+			return;
+
+		Request request = std::move(m_Queued.front());
+		m_Queued.pop_front();
+		m_Decoding++;
+		const bool compress = m_CompressOnLoad;
+
+		// decoding is the slow part, so nobody waits on the lock while we do it
+		lock.unlock();
+		double start = nowMs();
+		const std::string& filePath = request.texture->getFilePath();
+		{
+			PROFILE_SCOPE("TextureLoader decode");
+			if(CompressedImage::isCompressedFile(filePath))
+				request.compressed = CompressedImage(filePath); // just reading the file, the blocks stay as they are
+			else
+				request.image = Image(filePath, !compress); // the block compressor takes RGBA8 only
+		}
+		request.decodeMs = nowMs() - start;
+
+		if(compress && request.image.isValid())
+		{
+			PROFILE_SCOPE("TextureLoader compress");
+			start = nowMs();
+			unsigned int format = request.image.hasAlpha() ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+			// blocks can't go through glGenerateMipmap, so the mip levels are made here
+			request.compressed = compressImage(request.image, generateMipChain(request.image), format);
+			request.image = Image(); // the compressed one is uploaded instead
+			request.compressMs = nowMs() - start;
+		}
+		lock.lock();
+
+		m_Decoding--;
+		m_Decoded.push_back(std::move(request));
+	}
+}
+
+unsigned int TextureLoader::processUploads(double budgetMs)
+{
+	PROFILE_SCOPE("TextureLoader::processUploads");
+	const double start = nowMs();
+	unsigned int uploaded = 0;
+	// every request taken off the queue, uploaded or not, so that one that failed doesn't end the loop early
+	unsigned int consumed = 0;
+
+	while(consumed == 0 || nowMs() - start < budgetMs)
+	{
+		Request request;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if(m_Decoded.empty())
+				break;
+			request = std::move(m_Decoded.front());
+			m_Decoded.pop_front();
+		}
+		consumed++;
+
+		const std::string& filePath = request.texture->getFilePath();
+		if(request.compressed.isValid())
+		{
+			/* compressed images are small, they skip the upload ring */
+			double uploadStart = nowMs();
+			request.texture->upload(request.compressed);
+			double end = nowMs();
+
+			m_Timings.push_back({filePath, request.decodeMs, request.compressMs, end - uploadStart, end - request.queuedAt, !request.texture->isLoaded()});
+			if(!request.texture->isLoaded())
+				m_Failed.push_back(request.texture);
+			uploaded++;
+			continue;
+		}
+
+		if(!request.image.isValid())
+		{
+			// keeps the placeholder, there is nothing else we could show
+			std::cout << "Failed to load texture '" << filePath << "'" << std::endl;
+			m_Timings.push_back({filePath, request.decodeMs, request.compressMs, 0.0, nowMs() - request.queuedAt, true});
+			m_Failed.push_back(request.texture);
+			continue;
+		}
+
+		if(m_UploadRing)
+		{
+			/* handing it to the ring is cheap, the ring spends the byte budget below */
+			double uploadStart = nowMs();
+			m_Streaming.push_back(request.texture);
+			m_UploadRing->upload(request.texture, std::move(request.image),
+					[this, texture = request.texture.get(), filePath, decodeMs = request.decodeMs, compressMs = request.compressMs,
+							queuedAt = request.queuedAt, uploadStart]() {
+						double end = nowMs();
+						m_Timings.push_back({filePath, decodeMs, compressMs, end - uploadStart, end - queuedAt, false});
+						std::erase_if(m_Streaming, [texture](const std::shared_ptr<Texture>& streaming) { return streaming.get() == texture; });
+					});
+			continue;
+		}
+
+		double uploadStart = nowMs();
+		request.texture->upload(request.image);
+		double end = nowMs();
+
+		m_Timings.push_back({filePath, request.decodeMs, request.compressMs, end - uploadStart, end - request.queuedAt, false});
+		uploaded++;
+	}
+
+	if(m_UploadRing)
+		uploaded += m_UploadRing->update(m_RingBytesPerFrame);
+	return uploaded;
+}
+
+unsigned int TextureLoader::getPendingCount() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Queued.size() + m_Decoding + m_Decoded.size() + m_Streaming.size();
+}
+
+void TextureLoader::printTimings() const
+{
+	for(const TextureLoadTiming& timing : m_Timings)
+	{
+		std::cout << timing.filePath << ": ";
+		if(timing.failed)
+			std::cout << "failed after " << timing.decodeMs << " ms" << std::endl;
+		else
+		{
+			std::cout << "decode " << timing.decodeMs << " ms, ";
+			if(timing.compressMs > 0.0)
+				std::cout << "compress " << timing.compressMs << " ms, ";
+			std::cout << "upload " << timing.uploadMs
+					  << " ms, ready after " << timing.totalMs << " ms" << std::endl;
+		}
+	}
+}
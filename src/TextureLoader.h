@@ -0,0 +1,107 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_TEXTURELOADER_H
+#define OPENGL_THECHERNO_TEXTURELOADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CompressedImage.h"
+#include "Image.h"
+#include "Texture.h"
+
+class PixelUploadRing;
+
+struct TextureLoadTiming
+{
+	std::string filePath;
+	double decodeMs; // on a worker thread
+	double compressMs; // on a worker thread too, 0 unless compressing on load
+	double uploadMs; // on the GL thread
+	double totalMs; // from load() until the texture had its pixels
+	bool failed;
+};
+
+/* Loads textures without blocking the GL thread.
+ *
+ * load() gives back the texture right away, bound to a placeholder. A pool of worker threads decodes
+ * the files, and processUploads(), called once a frame on the GL thread, uploads the decoded images
+ * until its time budget for the frame is used up. After that the texture binds its own pixels.
+ *
+ * With a PixelUploadRing the uploads go through pixel buffers instead, a few megabytes per frame,
+ * and big textures arrive in bands of rows over several frames.
+ *
+ * With setCompressOnLoad() the workers also block compress the images (BC1, or BC3 when they have alpha),
+ * which takes a quarter or an eighth of the video memory and upload bandwidth for some quality
+ * */
+class TextureLoader
+{
+private:
+	struct Request
+	{
+		std::shared_ptr<Texture> texture;
+		Image image;
+		CompressedImage compressed; // for .dds and .ktx2 files, instead of image
+		double queuedAt;
+		double decodeMs;
+		double compressMs;
+	};
+
+	std::vector<std::thread> m_Workers;
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_WorkAvailable;
+	std::deque<Request> m_Queued; // waiting for a worker
+	std::deque<Request> m_Decoded; // waiting for the GL thread
+	unsigned int m_Decoding; // taken by a worker, not decoded yet
+	bool m_Stopping;
+	bool m_CompressOnLoad;
+
+	Texture m_Placeholder;
+	// failed to load, they keep binding the placeholder for as long as we're around
+	std::vector<std::weak_ptr<Texture>> m_Failed;
+	std::vector<TextureLoadTiming> m_Timings;
+
+	PixelUploadRing* m_UploadRing;
+	size_t m_RingBytesPerFrame;
+	std::vector<std::shared_ptr<Texture>> m_Streaming; // handed to the ring, not complete yet
+public:
+	/* 0 workers means one less than the number of cores */
+	explicit TextureLoader(unsigned int workerCount = 0);
+	~TextureLoader();
+
+	TextureLoader(const TextureLoader&) = delete;
+	TextureLoader& operator=(const TextureLoader&) = delete;
+
+	std::shared_ptr<Texture> load(const std::string& filePath);
+
+	/* stream uploads through the ring, at most bytesPerFrame per processUploads(). nullptr goes back to glTexImage2D.
+	 * The ring has to outlive the loader, which cancels what it still has in there when it's destroyed */
+	void setUploadRing(PixelUploadRing* ring, size_t bytesPerFrame = 8 * 1024 * 1024);
+
+	/* Compress decoded images on the workers before they are uploaded. Applies to textures loaded after
+	 * the call. Must be called on the GL thread, returns false when the driver can't take BC1 and BC3 */
+	bool setCompressOnLoad(bool compress);
+
+	/* Uploads decoded images until budgetMs has passed, but always at least one so that loading
+	 * can't stall. Must be called on the GL thread. Returns how many textures were uploaded */
+	unsigned int processUploads(double budgetMs);
+
+	/* textures that don't have their pixels yet */
+	unsigned int getPendingCount() const;
+	inline const Texture& getPlaceholder() const { return m_Placeholder; }
+
+	[[nodiscard]] inline const std::vector<TextureLoadTiming>& getTimings() const { return m_Timings; }
+	void printTimings() const;
+
+private:
+	void workerLoop();
+};
+
+
+#endif //OPENGL_THECHERNO_TEXTURELOADER_H
@@ -0,0 +1,197 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "TextureStreamer.h"
+#include "Mipmap.h"
+#include "Texture.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+TextureStreamer::TextureStreamer(size_t poolSize, int tailSize, size_t keepFrames)
+	: m_PoolSize(poolSize), m_TailSize(std::max(tailSize, 1)), m_Frame(0), m_KeepFrames(keepFrames),
+	m_StreamedBytes(0), m_DroppedBytes(0)
+{
+}
+
+std::shared_ptr<Texture> TextureStreamer::add(Image image)
+{
+	if(!image.isValid())
+		return nullptr;
+	// the mip chain is made on the cpu, and generateMipChain() only takes RGBA8
+	if(image.getFormat() != PixelFormat::RGBA8)
+	{
+		std::cout << "TextureStreamer: only RGBA8 images can be streamed" << std::endl;
+		return nullptr;
+	}
+
+	Entry entry;
+	entry.levels.reserve(getMipLevelCount(image.getWidth(), image.getHeight()));
+	std::vector<Image> mipChain = generateMipChain(image, true, std::max(1u, std::thread::hardware_concurrency()));
+	entry.levels.push_back(std::move(image));
+	for(Image& level : mipChain)
+		entry.levels.push_back(std::move(level));
+
+	entry.texture = std::make_shared<Texture>(std::string(), nullptr);
+	entry.texture->allocateStreamed(entry.levels[0].getWidth(), entry.levels[0].getHeight());
+	entry.targetLevel = getTailLevel(entry);
+	entry.lastRequestFrame = m_Frame;
+
+	// the tail goes in right away, so there's something to sample from the first frame
+	for(int level = static_cast<int>(entry.levels.size()) - 1; level >= entry.targetLevel; level--)
+		entry.texture->streamLevel(level, entry.levels[level].getPixels());
+
+	m_Entries.push_back(std::move(entry));
+	return m_Entries.back().texture;
+}
+
+std::shared_ptr<Texture> TextureStreamer::add(const std::string& filePath)
+{
+	Image image(filePath);
+	if(!image.isValid())
+	{
+		std::cout << "TextureStreamer: can't load '" << filePath << "'" << std::endl;
+		return nullptr;
+	}
+	return add(std::move(image));
+}
+
+void TextureStreamer::remove(const std::shared_ptr<Texture>& texture)
+{
+	auto entry = std::find_if(m_Entries.begin(), m_Entries.end(), [&](const Entry& e) { return e.texture == texture; });
+	if(entry != m_Entries.end())
+		m_Entries.erase(entry);
+}
+
+unsigned int TextureStreamer::update(size_t uploadBudget)
+{
+	m_Frame++;
+
+	for(Entry& entry : m_Entries)
+	{
+		const int tail = getTailLevel(entry);
+		const int requested = entry.texture->takeRequestedLevel();
+		if(requested >= 0)
+		{
+			entry.lastRequestFrame = m_Frame;
+			entry.targetLevel = std::min(requested, tail);
+		}
+		/* Not drawn this frame. It may be behind the camera for a moment, so the levels stay
+		 * for a while before it goes back to the tail */
+		else if(m_Frame - entry.lastRequestFrame > m_KeepFrames)
+			entry.targetLevel = tail;
+	}
+	fitTargetsToPool();
+
+	// dropping first makes the room for what's streamed in below
+	for(Entry& entry : m_Entries)
+	{
+		while(entry.texture->getResidentLevel() < entry.targetLevel)
+		{
+			m_DroppedBytes += Texture::getLevelSize(entry.texture->getWidth(), entry.texture->getHeight(), entry.texture->getResidentLevel());
+			entry.texture->dropLevel();
+		}
+	}
+
+	/* The blurriest ones (furthest from their target) first, one level each: a texture that's missing
+	 * several levels gets a little sharper every frame instead of holding the others up */
+	std::vector<Entry*> wanting;
+	for(Entry& entry : m_Entries)
+	{
+		if(entry.texture->getResidentLevel() > entry.targetLevel)
+			wanting.push_back(&entry);
+	}
+	std::sort(wanting.begin(), wanting.end(), [](const Entry* a, const Entry* b)
+	{
+		return a->texture->getResidentLevel() - a->targetLevel > b->texture->getResidentLevel() - b->targetLevel;
+	});
+
+	unsigned int streamed = 0;
+	size_t uploaded = 0;
+	for(Entry* entry : wanting)
+	{
+		const int level = entry->texture->getResidentLevel() - 1;
+		const size_t size = entry->levels[level].getSize();
+		// a level larger than the whole budget still goes in, alone
+		if(streamed > 0 && uploaded + size > uploadBudget)
+			continue;
+		entry->texture->streamLevel(level, entry->levels[level].getPixels());
+		uploaded += size;
+		streamed++;
+	}
+	m_StreamedBytes += uploaded;
+	return streamed;
+}
+
+void TextureStreamer::fitTargetsToPool()
+{
+	size_t total = 0;
+	for(const Entry& entry : m_Entries)
+		total += getSizeFrom(entry, entry.targetLevel);
+
+	/* Give up the largest level any texture wants until it fits. The largest level is where the most
+	 * memory comes back, and it's the texture that's sharpest on screen for its size that loses it */
+	while(total > m_PoolSize)
+	{
+		Entry* largest = nullptr;
+		size_t largestSize = 0;
+		for(Entry& entry : m_Entries)
+		{
+			if(entry.targetLevel >= getTailLevel(entry))
+				continue;
+			const size_t size = entry.levels[entry.targetLevel].getSize();
+			// the same size: the one that was drawn least recently gives
+			if(size > largestSize || (size == largestSize && largest && entry.lastRequestFrame < largest->lastRequestFrame))
+			{
+				largest = &entry;
+				largestSize = size;
+			}
+		}
+		if(!largest)
+			break; // only the tails are left, they stay whatever the pool
+		largest->targetLevel++;
+		total -= largestSize;
+	}
+}
+
+int TextureStreamer::getTailLevel(const Entry& entry) const
+{
+	int level = 0;
+	while(level + 1 < static_cast<int>(entry.levels.size())
+		  && std::max(entry.levels[level].getWidth(), entry.levels[level].getHeight()) > m_TailSize)
+		level++;
+	return level;
+}
+
+size_t TextureStreamer::getSizeFrom(const Entry& entry, int level) const
+{
+	size_t size = 0;
+	for(size_t i = level; i < entry.levels.size(); i++)
+		size += entry.levels[i].getSize();
+	return size;
+}
+
+size_t TextureStreamer::getResidentSize() const
+{
+	size_t size = 0;
+	for(const Entry& entry : m_Entries)
+		size += entry.texture->getMemorySize();
+	return size;
+}
+
+void TextureStreamer::printStats() const
+{
+	std::cout << "TextureStreamer: " << m_Entries.size() << " textures, " << getResidentSize() / 1024 << " of "
+			  << m_PoolSize / 1024 << " KB resident, " << m_StreamedBytes / 1024 << " KB streamed in, "
+			  << m_DroppedBytes / 1024 << " KB dropped" << std::endl;
+}
+
+float getProjectedSize(float worldSize, float distance, float fovY, float viewportHeight)
+{
+	if(distance <= 0.0f)
+		return viewportHeight;
+	// at this distance the viewport is 2 * distance * tan(fovY / 2) world units high
+	return worldSize / (2.0f * distance * std::tan(fovY * 0.5f)) * viewportHeight;
+}
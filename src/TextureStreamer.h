@@ -0,0 +1,83 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_TEXTURESTREAMER_H
+#define OPENGL_THECHERNO_TEXTURESTREAMER_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Image.h"
+
+class Texture;
+
+/* Keeps many textures in a fixed amount of video memory by having only the mip levels in it that are
+ * actually seen.
+ *
+ * A streamed texture starts with its small levels (up to tailSize wide and high) and nothing else.
+ * Whoever draws it tells the texture how big it is on screen (Texture::requestScreenSize(), see
+ * getProjectedSize()), and update() streams in the finer levels that size needs, a level per texture
+ * per frame, coarse to fine. Textures that weren't drawn for a while, and textures that are further away
+ * than their levels need, have their fine levels dropped again. When the levels asked for don't fit the
+ * pool, the largest ones are given up first, so the textures get blurrier together rather than some
+ * disappearing.
+ *
+ * The pixels of every level are kept in system memory, the pool only limits video memory. Must be used
+ * on the GL thread */
+class TextureStreamer
+{
+private:
+	struct Entry
+	{
+		std::shared_ptr<Texture> texture;
+		std::vector<Image> levels; // all of them, level 0 first
+		int targetLevel; // the finest level we want resident
+		size_t lastRequestFrame;
+	};
+
+	std::vector<Entry> m_Entries;
+	size_t m_PoolSize;
+	int m_TailSize;
+	size_t m_Frame;
+	size_t m_KeepFrames;
+	size_t m_StreamedBytes, m_DroppedBytes;
+public:
+	/* poolSize in bytes of video memory. Levels of at most tailSize by tailSize are always resident.
+	 * A texture that isn't drawn for keepFrames frames goes back to those */
+	explicit TextureStreamer(size_t poolSize = 128 * 1024 * 1024, int tailSize = 64, size_t keepFrames = 120);
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	/* A streamed texture of the image, with its small levels uploaded. The mip chain is made here.
+	 * nullptr unless the image is RGBA8 (files are loaded as RGBA8) */
+	std::shared_ptr<Texture> add(Image image);
+	std::shared_ptr<Texture> add(const std::string& filePath);
+	void remove(const std::shared_ptr<Texture>& texture);
+
+	/* Once a frame, after the draws: picks the levels every texture needs from what was requested,
+	 * drops what's over, then streams in levels of at most uploadBudget bytes in total.
+	 * Returns how many levels were streamed in */
+	unsigned int update(size_t uploadBudget = 4 * 1024 * 1024);
+
+	inline void setPoolSize(size_t poolSize) { m_PoolSize = poolSize; }
+	inline size_t getPoolSize() const { return m_PoolSize; }
+	/* bytes of video memory the resident levels take */
+	size_t getResidentSize() const;
+	inline size_t getTextureCount() const { return m_Entries.size(); }
+	void printStats() const;
+
+private:
+	int getTailLevel(const Entry& entry) const;
+	size_t getSizeFrom(const Entry& entry, int level) const;
+	void fitTargetsToPool();
+};
+
+/* How many pixels something worldSize across covers on screen at distance, with a perspective
+ * projection of fovY radians (vertically) onto a viewport viewportHeight pixels high */
+float getProjectedSize(float worldSize, float distance, float fovY, float viewportHeight);
+
+
+#endif //OPENGL_THECHERNO_TEXTURESTREAMER_H
@@ -0,0 +1,208 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#include "UniformTable.h"
+#include <GL/glew.h>
+#include <cstring>
+
+UniformTypeInfo getUniformTypeInfo(unsigned int type)
+{
+	switch(type)
+	{
+		case GL_FLOAT:				return {GL_FLOAT, 1, 1, false, "float"};
+		case GL_FLOAT_VEC2:			return {GL_FLOAT, 2, 1, false, "vec2"};
+		case GL_FLOAT_VEC3:			return {GL_FLOAT, 3, 1, false, "vec3"};
+		case GL_FLOAT_VEC4:			return {GL_FLOAT, 4, 1, false, "vec4"};
+		case GL_INT:				return {GL_INT, 1, 1, false, "int"};
+		case GL_INT_VEC2:			return {GL_INT, 2, 1, false, "ivec2"};
+		case GL_INT_VEC3:			return {GL_INT, 3, 1, false, "ivec3"};
+		case GL_INT_VEC4:			return {GL_INT, 4, 1, false, "ivec4"};
+		case GL_UNSIGNED_INT:		return {GL_UNSIGNED_INT, 1, 1, false, "uint"};
+		case GL_UNSIGNED_INT_VEC2:	return {GL_UNSIGNED_INT, 2, 1, false, "uvec2"};
+		case GL_UNSIGNED_INT_VEC3:	return {GL_UNSIGNED_INT, 3, 1, false, "uvec3"};
+		case GL_UNSIGNED_INT_VEC4:	return {GL_UNSIGNED_INT, 4, 1, false, "uvec4"};
+		case GL_BOOL:				return {GL_BOOL, 1, 1, false, "bool"};
+		case GL_BOOL_VEC2:			return {GL_BOOL, 2, 1, false, "bvec2"};
+		case GL_BOOL_VEC3:			return {GL_BOOL, 3, 1, false, "bvec3"};
+		case GL_BOOL_VEC4:			return {GL_BOOL, 4, 1, false, "bvec4"};
+		case GL_FLOAT_MAT2:			return {GL_FLOAT, 4, 2, false, "mat2"};
+		case GL_FLOAT_MAT3:			return {GL_FLOAT, 9, 3, false, "mat3"};
+		case GL_FLOAT_MAT4:			return {GL_FLOAT, 16, 4, false, "mat4"};
+		case GL_FLOAT_MAT2x3:		return {GL_FLOAT, 6, 2, false, "mat2x3"};
+		case GL_FLOAT_MAT2x4:		return {GL_FLOAT, 8, 2, false, "mat2x4"};
+		case GL_FLOAT_MAT3x2:		return {GL_FLOAT, 6, 3, false, "mat3x2"};
+		case GL_FLOAT_MAT3x4:		return {GL_FLOAT, 12, 3, false, "mat3x4"};
+		case GL_FLOAT_MAT4x2:		return {GL_FLOAT, 8, 4, false, "mat4x2"};
+		case GL_FLOAT_MAT4x3:		return {GL_FLOAT, 12, 4, false, "mat4x3"};
+		// samplers are set with glUniform1i, the value is the texture slot
+		case GL_SAMPLER_1D:			return {GL_INT, 1, 1, true, "sampler1D"};
+		case GL_SAMPLER_2D:			return {GL_INT, 1, 1, true, "sampler2D"};
+		case GL_SAMPLER_3D:			return {GL_INT, 1, 1, true, "sampler3D"};
+		case GL_SAMPLER_CUBE:		return {GL_INT, 1, 1, true, "samplerCube"};
+		case GL_SAMPLER_1D_SHADOW:	return {GL_INT, 1, 1, true, "sampler1DShadow"};
+		case GL_SAMPLER_2D_SHADOW:	return {GL_INT, 1, 1, true, "sampler2DShadow"};
+		case GL_SAMPLER_1D_ARRAY:	return {GL_INT, 1, 1, true, "sampler1DArray"};
+		case GL_SAMPLER_2D_ARRAY:	return {GL_INT, 1, 1, true, "sampler2DArray"};
+		case GL_SAMPLER_1D_ARRAY_SHADOW:	return {GL_INT, 1, 1, true, "sampler1DArrayShadow"};
+		case GL_SAMPLER_2D_ARRAY_SHADOW:	return {GL_INT, 1, 1, true, "sampler2DArrayShadow"};
+		case GL_SAMPLER_2D_MULTISAMPLE:	return {GL_INT, 1, 1, true, "sampler2DMS"};
+		case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:	return {GL_INT, 1, 1, true, "sampler2DMSArray"};
+		case GL_SAMPLER_CUBE_SHADOW:	return {GL_INT, 1, 1, true, "samplerCubeShadow"};
+		case GL_SAMPLER_BUFFER:		return {GL_INT, 1, 1, true, "samplerBuffer"};
+		case GL_SAMPLER_2D_RECT:		return {GL_INT, 1, 1, true, "sampler2DRect"};
+		case GL_SAMPLER_2D_RECT_SHADOW:	return {GL_INT, 1, 1, true, "sampler2DRectShadow"};
+		case GL_SAMPLER_CUBE_MAP_ARRAY:	return {GL_INT, 1, 1, true, "samplerCubeArray"};
+		case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:	return {GL_INT, 1, 1, true, "samplerCubeArrayShadow"};
+		case GL_INT_SAMPLER_1D:		return {GL_INT, 1, 1, true, "isampler1D"};
+		case GL_INT_SAMPLER_2D:		return {GL_INT, 1, 1, true, "isampler2D"};
+		case GL_INT_SAMPLER_3D:		return {GL_INT, 1, 1, true, "isampler3D"};
+		case GL_INT_SAMPLER_CUBE:	return {GL_INT, 1, 1, true, "isamplerCube"};
+		case GL_INT_SAMPLER_1D_ARRAY:	return {GL_INT, 1, 1, true, "isampler1DArray"};
+		case GL_INT_SAMPLER_2D_ARRAY:	return {GL_INT, 1, 1, true, "isampler2DArray"};
+		case GL_INT_SAMPLER_2D_MULTISAMPLE:	return {GL_INT, 1, 1, true, "isampler2DMS"};
+		case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:	return {GL_INT, 1, 1, true, "isampler2DMSArray"};
+		case GL_INT_SAMPLER_BUFFER:	return {GL_INT, 1, 1, true, "isamplerBuffer"};
+		case GL_INT_SAMPLER_2D_RECT:	return {GL_INT, 1, 1, true, "isampler2DRect"};
+		case GL_INT_SAMPLER_CUBE_MAP_ARRAY:	return {GL_INT, 1, 1, true, "isamplerCubeArray"};
+		case GL_UNSIGNED_INT_SAMPLER_1D:	return {GL_INT, 1, 1, true, "usampler1D"};
+		case GL_UNSIGNED_INT_SAMPLER_2D:	return {GL_INT, 1, 1, true, "usampler2D"};
+		case GL_UNSIGNED_INT_SAMPLER_3D:	return {GL_INT, 1, 1, true, "usampler3D"};
+		case GL_UNSIGNED_INT_SAMPLER_CUBE:	return {GL_INT, 1, 1, true, "usamplerCube"};
+		case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:	return {GL_INT, 1, 1, true, "usampler1DArray"};
+		case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:	return {GL_INT, 1, 1, true, "usampler2DArray"};
+		case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:	return {GL_INT, 1, 1, true, "usampler2DMS"};
+		case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:	return {GL_INT, 1, 1, true, "usampler2DMSArray"};
+		case GL_UNSIGNED_INT_SAMPLER_BUFFER:	return {GL_INT, 1, 1, true, "usamplerBuffer"};
+		case GL_UNSIGNED_INT_SAMPLER_2D_RECT:	return {GL_INT, 1, 1, true, "usampler2DRect"};
+		case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:	return {GL_INT, 1, 1, true, "usamplerCubeArray"};
+		// and images with the image unit
+		case GL_IMAGE_1D:			return {GL_INT, 1, 1, true, "image1D"};
+		case GL_IMAGE_2D:			return {GL_INT, 1, 1, true, "image2D"};
+		case GL_IMAGE_3D:			return {GL_INT, 1, 1, true, "image3D"};
+		case GL_IMAGE_CUBE:			return {GL_INT, 1, 1, true, "imageCube"};
+		case GL_IMAGE_1D_ARRAY:		return {GL_INT, 1, 1, true, "image1DArray"};
+		case GL_IMAGE_2D_ARRAY:		return {GL_INT, 1, 1, true, "image2DArray"};
+		case GL_IMAGE_2D_MULTISAMPLE:	return {GL_INT, 1, 1, true, "image2DMS"};
+		case GL_IMAGE_2D_MULTISAMPLE_ARRAY:	return {GL_INT, 1, 1, true, "image2DMSArray"};
+		case GL_IMAGE_BUFFER:		return {GL_INT, 1, 1, true, "imageBuffer"};
+		case GL_IMAGE_2D_RECT:		return {GL_INT, 1, 1, true, "image2DRect"};
+		case GL_IMAGE_CUBE_MAP_ARRAY:	return {GL_INT, 1, 1, true, "imageCubeArray"};
+		case GL_INT_IMAGE_1D:		return {GL_INT, 1, 1, true, "iimage1D"};
+		case GL_INT_IMAGE_2D:		return {GL_INT, 1, 1, true, "iimage2D"};
+		case GL_INT_IMAGE_3D:		return {GL_INT, 1, 1, true, "iimage3D"};
+		case GL_INT_IMAGE_CUBE:		return {GL_INT, 1, 1, true, "iimageCube"};
+		case GL_INT_IMAGE_1D_ARRAY:	return {GL_INT, 1, 1, true, "iimage1DArray"};
+		case GL_INT_IMAGE_2D_ARRAY:	return {GL_INT, 1, 1, true, "iimage2DArray"};
+		case GL_INT_IMAGE_2D_MULTISAMPLE:	return {GL_INT, 1, 1, true, "iimage2DMS"};
+		case GL_INT_IMAGE_2D_MULTISAMPLE_ARRAY:	return {GL_INT, 1, 1, true, "iimage2DMSArray"};
+		case GL_INT_IMAGE_BUFFER:	return {GL_INT, 1, 1, true, "iimageBuffer"};
+		case GL_INT_IMAGE_2D_RECT:	return {GL_INT, 1, 1, true, "iimage2DRect"};
+		case GL_INT_IMAGE_CUBE_MAP_ARRAY:	return {GL_INT, 1, 1, true, "iimageCubeArray"};
+		case GL_UNSIGNED_INT_IMAGE_1D:	return {GL_INT, 1, 1, true, "uimage1D"};
+		case GL_UNSIGNED_INT_IMAGE_2D:	return {GL_INT, 1, 1, true, "uimage2D"};
+		case GL_UNSIGNED_INT_IMAGE_3D:	return {GL_INT, 1, 1, true, "uimage3D"};
+		case GL_UNSIGNED_INT_IMAGE_CUBE:	return {GL_INT, 1, 1, true, "uimageCube"};
+		case GL_UNSIGNED_INT_IMAGE_1D_ARRAY:	return {GL_INT, 1, 1, true, "uimage1DArray"};
+		case GL_UNSIGNED_INT_IMAGE_2D_ARRAY:	return {GL_INT, 1, 1, true, "uimage2DArray"};
+		case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE:	return {GL_INT, 1, 1, true, "uimage2DMS"};
+		case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY:	return {GL_INT, 1, 1, true, "uimage2DMSArray"};
+		case GL_UNSIGNED_INT_IMAGE_BUFFER:	return {GL_INT, 1, 1, true, "uimageBuffer"};
+		case GL_UNSIGNED_INT_IMAGE_2D_RECT:	return {GL_INT, 1, 1, true, "uimage2DRect"};
+		case GL_UNSIGNED_INT_IMAGE_CUBE_MAP_ARRAY:	return {GL_INT, 1, 1, true, "uimageCubeArray"};
+	}
+	// doubles, atomic counters... we reflect them but can't set them
+	return {0, 0, 0, false, "unsupported type"};
+}
+
+void UniformTable::clear()
+{
+	m_Uniforms.clear();
+	m_Slots.clear();
+	m_Values.clear();
+	m_Dirty.clear();
+}
+
+UniformHandle UniformTable::add(std::string name, int location, unsigned int type, int count)
+{
+	uint32_t hash = hashUniformName(name);
+	unsigned int elementSize = getUniformTypeInfo(type).components * sizeof(uint32_t);
+	unsigned int offset = m_Values.size() * sizeof(uint32_t);
+	/* zeroed, like the uniforms of a freshly linked program. Not those with an initializer in the GLSL
+	 * (uniform float u_X = 1.0;), Shader reads every value back with setInitialValue() */
+	m_Values.resize(m_Values.size() + elementSize * count / sizeof(uint32_t), 0);
+
+	m_Uniforms.push_back({std::move(name), hash, location, type, count, elementSize, offset, false});
+	int index = static_cast<int>(m_Uniforms.size()) - 1;
+
+	// keep the table at most half full so that probe sequences stay short
+	if(m_Uniforms.size() * 2 > m_Slots.size())
+		rehash(m_Slots.empty() ? 16 : m_Slots.size() * 2);
+	else
+		insertSlot(index);
+
+	return {index};
+}
+
+UniformHandle UniformTable::find(const UniformName& name) const
+{
+	if(m_Slots.empty())
+		return {};
+
+	const unsigned int mask = m_Slots.size() - 1;
+	for(unsigned int slot = name.hash & mask; ; slot = (slot + 1) & mask)
+	{
+		int index = m_Slots[slot];
+		if(index < 0)
+			return {};
+
+		// compare the names as well, two different names can have the same hash
+		const UniformInfo& info = m_Uniforms[index];
+		if(info.hash == name.hash && info.name == name.name)
+			return {index};
+	}
+}
+
+void UniformTable::insertSlot(int index)
+{
+	const unsigned int mask = m_Slots.size() - 1;
+	unsigned int slot = m_Uniforms[index].hash & mask;
+	while(m_Slots[slot] >= 0)
+		slot = (slot + 1) & mask;
+	m_Slots[slot] = index;
+}
+
+void UniformTable::rehash(unsigned int slotCount)
+{
+	m_Slots.assign(slotCount, -1);
+	for(unsigned int i = 0; i < m_Uniforms.size(); i++)
+		insertSlot(static_cast<int>(i));
+}
+
+void UniformTable::setInitialValue(UniformHandle handle, const void* data, unsigned int bytes)
+{
+	std::memcpy(reinterpret_cast<unsigned char*>(m_Values.data()) + m_Uniforms[handle.index].offset, data, bytes);
+}
+
+bool UniformTable::write(UniformHandle handle, const void* data, unsigned int bytes)
+{
+	UniformInfo& info = m_Uniforms[handle.index];
+	unsigned char* value = reinterpret_cast<unsigned char*>(m_Values.data()) + info.offset;
+	if(std::memcmp(value, data, bytes) == 0)
+		return false; // same value as the last one, nothing to upload
+
+	std::memcpy(value, data, bytes);
+	if(!info.dirty)
+	{
+		info.dirty = true;
+		m_Dirty.push_back(handle.index);
+	}
+	return true;
+}
+
+void UniformTable::clearDirty()
+{
+	for(int index : m_Dirty)
+		m_Uniforms[index].dirty = false;
+	m_Dirty.clear();
+}
@@ -0,0 +1,143 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+#ifndef OPENGL_THECHERNO_UNIFORMTABLE_H
+#define OPENGL_THECHERNO_UNIFORMTABLE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* FNV-1a hash of a uniform name. It is constexpr so that a literal like "u_Color"
+ * is hashed by the compiler and not by us every frame */
+constexpr uint32_t hashUniformName(std::string_view name)
+{
+	uint32_t hash = 2166136261u;
+	for(char c : name)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/* A uniform name together with its hash. Building one from a string literal doesn't allocate,
+ * unlike the std::string we used to build for every setUniform call */
+struct UniformName
+{
+	std::string_view name;
+	uint32_t hash;
+
+	constexpr UniformName(const char* uniformName)
+		: name(uniformName), hash(hashUniformName(name))
+	{}
+	constexpr UniformName(std::string_view uniformName)
+		: name(uniformName), hash(hashUniformName(name))
+	{}
+	UniformName(const std::string& uniformName)
+		: name(uniformName), hash(hashUniformName(name))
+	{}
+};
+
+/* Index of a uniform in the program's reflected uniform array. Get it once with
+ * Shader::getUniformHandle() and every setUniform after that is a plain array access */
+struct UniformHandle
+{
+	int index = -1;
+
+	inline bool isValid() const { return index >= 0; }
+};
+
+/* Either a handle or a name, so that every setUniform takes both without being written twice */
+struct UniformRef
+{
+	UniformHandle handle;
+	UniformName name;
+
+	constexpr UniformRef(UniformHandle uniformHandle)
+		: handle(uniformHandle), name(std::string_view())
+	{}
+	constexpr UniformRef(const char* uniformName)
+		: name(uniformName)
+	{}
+	constexpr UniformRef(std::string_view uniformName)
+		: name(uniformName)
+	{}
+	UniformRef(const std::string& uniformName)
+		: name(uniformName)
+	{}
+};
+
+/* What a reflected GLSL type is made of. GL_FLOAT_MAT3 is 9 GL_FLOATs in 3 columns,
+ * a sampler2D is a single GL_INT (the texture slot) */
+struct UniformTypeInfo
+{
+	unsigned int componentType; // GL_FLOAT, GL_INT, GL_UNSIGNED_INT or GL_BOOL. 0 for types we can't shadow
+	unsigned int components; // total number of components, 16 for a mat4
+	unsigned int columns; // 1 unless it's a matrix
+	bool sampler;
+	const char* glslName;
+};
+
+UniformTypeInfo getUniformTypeInfo(unsigned int type);
+
+struct UniformInfo
+{
+	std::string name; // arrays are stored without the "[0]" suffix
+	uint32_t hash;
+	int location;
+	unsigned int type; // GL_FLOAT_VEC4, GL_SAMPLER_2D, ...
+	int count; // number of array elements, 1 for non arrays
+	unsigned int elementSize; // bytes of one array element in the shadow copy
+	unsigned int offset; // where the value starts in the shadow copy
+	bool dirty;
+};
+
+/* Flat array of the active uniforms of a program, filled once at link time.
+ * Names are found through a small open addressing table of hashes, so a lookup never allocates
+ * and hashes at most once (zero times if the UniformName was built at compile time)
+ *
+ * The table also keeps a CPU copy (shadow) of every uniform value. Writing the value a uniform
+ * already has does nothing, writing a new one marks it dirty, and only dirty uniforms get uploaded */
+class UniformTable
+{
+private:
+	std::vector<UniformInfo> m_Uniforms;
+	std::vector<int> m_Slots; // index into m_Uniforms, -1 for an empty slot. Size is a power of two
+	std::vector<uint32_t> m_Values; // the shadow. every GLSL component we support is 4 bytes
+	std::vector<int> m_Dirty; // indices of the uniforms changed since the last clearDirty()
+public:
+	void clear();
+	UniformHandle add(std::string name, int location, unsigned int type, int count);
+
+	UniformHandle find(const UniformName& name) const;
+
+	inline const UniformInfo& operator[](UniformHandle handle) const { return m_Uniforms[handle.index]; }
+	inline int getLocation(UniformHandle handle) const
+	{
+		return handle.isValid() ? m_Uniforms[handle.index].location : -1;
+	}
+	inline unsigned int size() const { return m_Uniforms.size(); }
+
+	/* the value the program already has, read back after linking. Sets the shadow without making it dirty */
+	void setInitialValue(UniformHandle handle, const void* data, unsigned int bytes);
+	/* copies 'bytes' bytes of data into the shadow of the uniform. returns true if the value changed */
+	bool write(UniformHandle handle, const void* data, unsigned int bytes);
+	inline const void* getValue(UniformHandle handle) const
+	{
+		return reinterpret_cast<const unsigned char*>(m_Values.data()) + m_Uniforms[handle.index].offset;
+	}
+
+	[[nodiscard]] inline const std::vector<int>& getDirty() const { return m_Dirty; }
+	void clearDirty();
+	[[nodiscard]] inline const std::vector<UniformInfo>& getUniforms() const { return m_Uniforms; }
+
+private:
+	void insertSlot(int index);
+	void rehash(unsigned int slotCount);
+};
+
+
+#endif //OPENGL_THECHERNO_UNIFORMTABLE_H
@@ -6,17 +6,34 @@
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 #include "Renderer.h"
+#include "RenderStats.h"
+#include "GLObjectRegistry.h"
+#include <utility>
 
-VertexArray::VertexArray()
+VertexArray::VertexArray(std::source_location location)
 {
 	glCall(glGenVertexArrays(1, &m_RendererID));
+	GLObjectRegistry::add(GLObjectType::VertexArray, m_RendererID, 0, location);
 }
 
 VertexArray::~VertexArray()
 {
+	GLObjectRegistry::remove(GLObjectType::VertexArray, m_RendererID);
 	glCall(glDeleteVertexArrays(1, &m_RendererID));
 }
 
+VertexArray::VertexArray(VertexArray&& other) noexcept
+	: m_RendererID(std::exchange(other.m_RendererID, 0))
+{
+}
+
+/* the other one takes our vertex array along and deletes it */
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	return *this;
+}
+
 void VertexArray::addBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
 {
 	bind(); // bind vertex array
@@ -82,6 +99,7 @@ void VertexArray::addBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 
 void VertexArray::bind() const
 {
+	RenderStats::current().vertexArrayBinds++;
 	glCall(glBindVertexArray(m_RendererID));
 }
 
@@ -5,17 +5,25 @@
 #ifndef OPENGL_THECHERNO_VERTEXARRAY_H
 #define OPENGL_THECHERNO_VERTEXARRAY_H
 
+#include <source_location>
+
 class VertexBuffer;
 class VertexBufferLayout;
 
+/* Owns its opengl vertex array: it can be moved but not copied, a copy would delete it twice */
 class VertexArray
 {
 private:
 	unsigned int m_RendererID;
 public:
-	VertexArray();
+	VertexArray(std::source_location location = std::source_location::current());
 	~VertexArray();
 
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+	VertexArray(VertexArray&& other) noexcept;
+	VertexArray& operator=(VertexArray&& other) noexcept;
+
 	void addBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
 	void bind() const;
 	void unBind() const;
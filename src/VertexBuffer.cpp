@@ -4,8 +4,11 @@
 
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "RenderStats.h"
+#include "GLObjectRegistry.h"
+#include <utility>
 
-VertexBuffer::VertexBuffer(const void *data, unsigned int size)
+VertexBuffer::VertexBuffer(const void *data, unsigned int size, std::source_location location)
 {
     /* I need 1 buffer. So give me one buffer. And put the address of the generated buffer
      * in the unsigned int m_Renderer_ID variable so that buffer variable contains the ID of the
@@ -29,13 +32,28 @@ VertexBuffer::VertexBuffer(const void *data, unsigned int size)
     // notice the memory improvement by using indices.
     // we now need only 4 vertices (8 floats) instead of 6 (12 floats)
     glCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	RenderStats::current().bufferBytes += size;
+	GLObjectRegistry::add(GLObjectType::VertexBuffer, m_Renderer_ID, size, location);
 }
 
 VertexBuffer::~VertexBuffer()
 {
+	GLObjectRegistry::remove(GLObjectType::VertexBuffer, m_Renderer_ID);
     glCall(glDeleteBuffers(1, &m_Renderer_ID));
 }
 
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+	: m_Renderer_ID(std::exchange(other.m_Renderer_ID, 0))
+{
+}
+
+/* the other one takes our buffer along and deletes it */
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+	std::swap(m_Renderer_ID, other.m_Renderer_ID);
+	return *this;
+}
+
 void VertexBuffer::bind() const
 {
     glCall(glBindBuffer(GL_ARRAY_BUFFER, m_Renderer_ID));
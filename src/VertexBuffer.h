@@ -5,14 +5,22 @@
 #ifndef OPENGL_THECHERNO_VERTEXBUFFER_H
 #define OPENGL_THECHERNO_VERTEXBUFFER_H
 
+#include <source_location>
+
+/* Owns its opengl buffer: it can be moved but not copied, a copy would delete the buffer twice */
 class VertexBuffer
 {
 private:
     unsigned int m_Renderer_ID;
 public:
-    VertexBuffer(const void* data, unsigned int size);
+    VertexBuffer(const void* data, unsigned int size, std::source_location location = std::source_location::current());
     ~VertexBuffer();
 
+    VertexBuffer(const VertexBuffer&) = delete;
+    VertexBuffer& operator=(const VertexBuffer&) = delete;
+    VertexBuffer(VertexBuffer&& other) noexcept;
+    VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+
     void bind() const;
     void unBind() const;
 };
@@ -49,5 +49,11 @@ public:
 	inline unsigned int getStride() const { return m_Stride; }
 };
 
+/* Defined in VertexBufferLayout.cpp. Without these declarations other files instantiate the empty push()
+ * above, and once the optimiser inlines it their layouts stay empty */
+template<> void VertexBufferLayout::push<float>(unsigned int count);
+template<> void VertexBufferLayout::push<unsigned int>(unsigned int count);
+template<> void VertexBufferLayout::push<unsigned char>(unsigned int count);
+
 
 #endif //OPENGL_THECHERNO_VERTEXBUFFERLAYOUT_H
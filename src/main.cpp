@@ -8,17 +8,74 @@
 
 #include "GL/glew.h"
 #include <GLFW/glfw3.h>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include "FrameTimer.h"
 #include "Renderer.h"
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "VertexBufferLayout.h"
 #include "Shader.h"
+#include "ShaderPack.h"
 #include "Texture.h"
+#include "TextureLibrary.h"
+#include "TextureLoader.h"
+#include "PixelUploadRing.h"
+#include "GpuProfiler.h"
+#include "Profiler.h"
+#include "RenderStats.h"
+#include "Material.h"
+#include "AllocationTracker.h"
+#include "GLObjectRegistry.h"
 
-int main()
+int main(int argc, char** argv)
 {
+	/* --compress-textures: block compress the textures while they load, see TextureLoader::setCompressOnLoad()
+	 * --trace <file>: write the profiler's timings there on exit, needs a build with -DENABLE_PROFILER=ON
+	 * --gpu-timings: print the cpu and gpu times of the passes and draws every few seconds
+	 * --stats-csv <file>: write the renderer's counters there, a line per frame
+	 * --no-vsync: draw as fast as we can, for measuring frame times
+	 * --allocations: report the heap allocations of the frames on exit, with where they come from
+	 * --assert-no-allocations: trap at the first allocation of a frame once the loop has warmed up
+	 * the last two need a build with -DENABLE_ALLOCATION_TRACKER=ON
+	 * --sync-points: report the opengl calls that can make us wait for the driver on exit, needs a build
+	 *   with -DENABLE_GL_SYNC_DIAGNOSTICS=ON
+	 * --gl-objects: list the GL objects that are alive when the window closes, with their sizes and where
+	 *   they were made. Objects that are never deleted are reported at exit either way */
+	bool compressTextures = false;
+	bool vsync = true;
+	bool printGpuTimings = false;
+	bool reportAllocations = false;
+	bool assertNoAllocations = false;
+	bool reportSyncPoints = false;
+	bool listGLObjects = false;
+	const char* tracePath = nullptr;
+	for(int i = 1; i < argc; i++)
+	{
+		if(std::strcmp(argv[i], "--compress-textures") == 0)
+			compressTextures = true;
+		else if(std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+			tracePath = argv[++i];
+		else if(std::strcmp(argv[i], "--gpu-timings") == 0)
+			printGpuTimings = true;
+		else if(std::strcmp(argv[i], "--stats-csv") == 0 && i + 1 < argc)
+			RenderStats::openCsv(argv[++i]);
+		else if(std::strcmp(argv[i], "--no-vsync") == 0)
+			vsync = false;
+		else if(std::strcmp(argv[i], "--allocations") == 0)
+			reportAllocations = true;
+		else if(std::strcmp(argv[i], "--assert-no-allocations") == 0)
+			assertNoAllocations = true;
+		else if(std::strcmp(argv[i], "--sync-points") == 0)
+			reportSyncPoints = true;
+		else if(std::strcmp(argv[i], "--gl-objects") == 0)
+			listGLObjects = true;
+	}
+	AllocationTracker::setCaptureStacks(reportAllocations);
+	PROFILE_THREAD("Main");
+
     GLFWwindow* window;
 
     /* Initialize the library */
@@ -40,8 +97,8 @@ int main()
     /* Make the window's context current */
     glfwMakeContextCurrent(window);
 
-    /* enable vsync*/
-    glfwSwapInterval(1);
+    /* enable vsync, unless we're measuring. With it every frame takes the refresh interval however fast it is */
+    glfwSwapInterval(vsync ? 1 : 0);
 
     if(glewInit() != GLEW_OK){
         std::cout << "Error" << std::endl;
@@ -76,38 +133,92 @@ int main()
 
 	IndexBuffer ib(indices, 6);
 
-	Shader shader("../res/shaders/Basic.shader");
-	shader.bind();
-	shader.setUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
+	/* shaders.pack is built next to the executable from everything in res/shaders (see tools/ShaderPacker.cpp).
+	 * If it isn't there we read the .shader file like before */
+	ShaderPack shaderPack("shaders.pack");
+	Shader shader = shaderPack.isOpen() ? Shader(shaderPack, "Basic") : Shader("../res/shaders/Basic.shader");
+	/* the png is decoded on another thread. Until it's uploaded (in the loop below) the texture shows a grey placeholder */
+	PixelUploadRing uploadRing;
+	TextureLoader textureLoader;
+	textureLoader.setUploadRing(&uploadRing); // uploads go through pixel buffers, a few MB per frame
+	textureLoader.setCompressOnLoad(compressTextures);
+	/* the library makes sure every file is loaded once, however many times it's asked for */
+	TextureLibrary textureLibrary(256 * 1024 * 1024, &textureLoader);
+	std::shared_ptr<Texture> texture = textureLibrary.acquire("../res/textures/pop.png");
+	TextureSampler sampler;
+	sampler.maxAnisotropy = 8.0f; // stays sharp when the quad is seen at an angle
+	texture->setSampler(sampler);
 
-	Texture texture("../res/textures/pop.png");
-	texture.bind(0);
-	shader.setUniform1i("u_Texture", 0);// this value should match above bind slot of texture
+	/* The material remembers which texture goes in which slot and the values of the uniforms.
+	 * The renderer binds all of it when we draw with the material */
+	Material material(shader);
+	material.setTexture("u_Texture", 0, *texture);
+	material.setUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
 
     /* Reset all our bindings*/
 	va.unBind();
 	vb.unBind();
 	ib.unBind();
-	shader.unBind();
 
 	Renderer renderer;
+	/* times every draw on the gpu, a few frames after the fact so we never wait for it. Only with
+	 * --gpu-timings, the queries and debug groups cost something every draw */
+	std::unique_ptr<GpuProfiler> gpuProfiler;
+	if(printGpuTimings)
+	{
+		gpuProfiler = std::make_unique<GpuProfiler>();
+		renderer.setGpuProfiler(gpuProfiler.get());
+	}
+	uint64_t lastPrintedGpuFrame = 0;
+	/* cpu, swap and whole frame times, reported when the window closes */
+	FrameTimer frameTimer;
+
+	/* look the uniform up once, in the loop setting it is just an index into the shader's uniforms */
+	UniformHandle colorUniform = shader.getUniformHandle("u_Color");
 
     float r = 0.0f;
     float increment = 0.05f;
+	/* the first frames allocate for good reasons, the driver compiles shaders and our pools grow to size */
+	constexpr uint64_t warmUpFrames = 120;
+	uint64_t frameCount = 0;
 
     /* Loop until the user closes the window */
     while (!glfwWindowShouldClose(window))
     {
+		if(assertNoAllocations && ++frameCount == warmUpFrames)
+			AllocationTracker::setAssertNoAllocations(true);
+		AllocationTracker::beginFrame();
+		PROFILE_SCOPE("Frame");
+		frameTimer.beginFrame();
+		if(gpuProfiler)
+		{
+			gpuProfiler->beginFrame();
+			/* a report arrives a few frames late and stays the last one until the next (frames the gpu
+			 * wasn't done with are skipped), so print the first new one every 300 frames */
+			const uint64_t gpuFrame = gpuProfiler->getLastReport().frame;
+			if(gpuFrame >= lastPrintedGpuFrame + 300)
+			{
+				gpuProfiler->printReport();
+				lastPrintedGpuFrame = gpuFrame;
+			}
+			gpuProfiler->beginScope("Main pass");
+		}
 		renderer.clear();
 
-		shader.bind();
-		/* Now that we got the location of the uniform (color vec4 in this case),
+		/* give the texture loader 2ms of this frame to upload whatever finished decoding */
+		if(textureLoader.processUploads(2.0) > 0 && textureLoader.getPendingCount() == 0)
+			textureLoader.printTimings();
+
+		/* Now that we got the handle of the uniform (color vec4 in this case),
 		 * we are setting the value of that color uniform from our cpu
-		 * we are updating red channel value per draw call
+		 * we are updating red channel value per draw call.
+		 * The material only remembers the value here, renderer.draw() uploads it if it changed
 		 * */
-		shader.setUniform4f("u_Color", r, 0.3f, 0.8f, 1.0f);
+		material.setUniform4f(colorUniform, r, 0.3f, 0.8f, 1.0f);
 
-		renderer.draw(va, ib, shader);
+		renderer.draw(va, ib, material);
+		if(gpuProfiler)
+			gpuProfiler->endScope();
 
         if(r > 1.0f)
             increment = -0.05f;
@@ -116,13 +227,35 @@ int main()
 
         r += increment;
 
-        /* Swap front and back buffers */
-        glfwSwapBuffers(window);
+		if(gpuProfiler)
+			gpuProfiler->endFrame();
+		RenderStats::endFrame();
+		SyncPointDetector::endFrame();
+		/* the swap and the events are the driver's and the window system's, not ours to count */
+		AllocationTracker::endFrame();
+
+        /* Swap front and back buffers. With vsync this is where we wait for the display */
+		{
+			PROFILE_SCOPE("glfwSwapBuffers");
+			frameTimer.beginSwap();
+			glfwSwapBuffers(window);
+			frameTimer.endSwap();
+		}
 
         /* Poll for and process events */
         glfwPollEvents();
     }
 
+	frameTimer.printReport();
+	if(reportAllocations)
+		AllocationTracker::printReport();
+	if(reportSyncPoints)
+		SyncPointDetector::printReport();
+	if(listGLObjects)
+		GLObjectRegistry::printLive();
+	if(tracePath)
+		Profiler::writeChromeTrace(tracePath);
+
     glfwTerminate();
     return 0;
 }
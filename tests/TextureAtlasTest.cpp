@@ -0,0 +1,200 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+/* MaxRectsPacker and TextureAtlas: packing, replacing and what happens when a page is full.
+ * The packer needs no opengl, the atlas gets a headless context and is skipped without one */
+
+#include "HeadlessContext.h"
+#include "Image.h"
+#include "TextureAtlas.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+	int failures = 0;
+
+	#define CHECK(x) check((x), #x, __LINE__)
+
+	void check(bool passed, const char* what, int line)
+	{
+		if(passed)
+			return;
+		std::cout << "  FAILED line " << line << ": " << what << std::endl;
+		failures++;
+	}
+
+	bool overlaps(const AtlasRect& a, const AtlasRect& b)
+	{
+		return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+	}
+
+	bool sameRect(const AtlasRect& a, const AtlasRect& b)
+	{
+		return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+	}
+
+	Image makeImage(int width, int height, unsigned char value)
+	{
+		Image image(width, height);
+		std::memset(image.getPixels(), value, image.getSize());
+		return image;
+	}
+
+	void testPackerFillsTheBin()
+	{
+		std::cout << "packer fills the bin" << std::endl;
+		MaxRectsPacker packer(128, 128);
+		std::vector<AtlasRect> placed;
+		AtlasRect rect{};
+		for(int i = 0; i < 4; i++)
+		{
+			CHECK(packer.insert(64, 64, rect));
+			placed.push_back(rect);
+		}
+		for(size_t i = 0; i < placed.size(); i++)
+		{
+			CHECK(placed[i].x >= 0 && placed[i].y >= 0 && placed[i].x + 64 <= 128 && placed[i].y + 64 <= 128);
+			for(size_t j = i + 1; j < placed.size(); j++)
+				CHECK(!overlaps(placed[i], placed[j]));
+		}
+		CHECK(packer.getOccupancy() == 1.0f);
+		CHECK(!packer.insert(1, 1, rect));
+	}
+
+	void testPackerReusesRemovedSpace()
+	{
+		std::cout << "packer reuses removed space" << std::endl;
+		MaxRectsPacker packer(128, 128);
+		AtlasRect big{}, small{}, rect{};
+		CHECK(packer.insert(128, 96, big));
+		CHECK(packer.insert(128, 32, small));
+		CHECK(!packer.insert(64, 64, rect));
+
+		packer.remove(big);
+		CHECK(packer.insert(64, 64, rect));
+		CHECK(!overlaps(rect, small));
+		CHECK(packer.insert(64, 64, rect));
+		CHECK(!overlaps(rect, small));
+
+		// what was taken back is in use again
+		packer.clear();
+		CHECK(packer.insert(128, 128, big));
+		packer.remove(big);
+		packer.restore(big);
+		CHECK(!packer.insert(1, 1, rect));
+	}
+
+	void testAtlasPacksWithPadding()
+	{
+		std::cout << "atlas packs with padding" << std::endl;
+		TextureAtlas atlas(128, 2, 1);
+		std::vector<AtlasRect> rects;
+		for(int i = 0; i < 4; i++)
+		{
+			const AtlasRegion* region = atlas.add("image" + std::to_string(i), makeImage(60, 60, static_cast<unsigned char>(i * 50)));
+			CHECK(region != nullptr);
+			if(!region)
+				return;
+			CHECK(region->page == 0);
+			CHECK(region->rect.width == 60 && region->rect.height == 60);
+			CHECK(region->u0 == static_cast<float>(region->rect.x) / 128.0f && region->u1 == static_cast<float>(region->rect.x + 60) / 128.0f);
+			rects.push_back({region->rect.x - 2, region->rect.y - 2, 64, 64});
+		}
+		for(size_t i = 0; i < rects.size(); i++)
+		{
+			for(size_t j = i + 1; j < rects.size(); j++)
+				CHECK(!overlaps(rects[i], rects[j]));
+		}
+		CHECK(atlas.getRegionCount() == 4);
+		CHECK(atlas.getPageCount() == 1);
+
+		// the pixels are where the region says, padding included
+		std::vector<unsigned char> pixels(128 * 128 * 4);
+		atlas.getPage(0).bind();
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		const AtlasRegion* region = atlas.find("image3");
+		auto texel = [&pixels](int x, int y) { return pixels[(static_cast<size_t>(y) * 128 + x) * 4]; };
+		CHECK(texel(region->rect.x, region->rect.y) == 150);
+		CHECK(texel(region->rect.x - 2, region->rect.y - 2) == 150);
+	}
+
+	void testAtlasReplace()
+	{
+		std::cout << "atlas replaces an image" << std::endl;
+		TextureAtlas atlas(128, 0, 1);
+		CHECK(atlas.add("a", makeImage(64, 128, 10)) != nullptr);
+		CHECK(atlas.add("b", makeImage(64, 128, 20)) != nullptr);
+
+		// the page is full, but a replacement fits where the old image was
+		const AtlasRegion* region = atlas.add("a", makeImage(64, 64, 30));
+		CHECK(region != nullptr);
+		CHECK(atlas.getRegionCount() == 2);
+		CHECK(region && atlas.find("a") == region && region->rect.width == 64 && region->rect.height == 64);
+	}
+
+	void testAtlasFullPage()
+	{
+		std::cout << "atlas keeps an image whose replacement doesn't fit" << std::endl;
+		TextureAtlas atlas(128, 0, 1);
+		const AtlasRegion* a = atlas.add("a", makeImage(64, 128, 10));
+		CHECK(a != nullptr);
+		CHECK(atlas.add("b", makeImage(64, 128, 20)) != nullptr);
+		if(!a)
+			return;
+		const AtlasRect before = a->rect;
+
+		CHECK(atlas.add("c", makeImage(8, 8, 30)) == nullptr);
+		CHECK(atlas.add("a", makeImage(96, 128, 40)) == nullptr);
+		const AtlasRegion* kept = atlas.find("a");
+		CHECK(kept != nullptr && sameRect(kept->rect, before));
+		CHECK(atlas.getRegionCount() == 2);
+		// and its space is still taken
+		CHECK(atlas.add("c", makeImage(64, 128, 50)) == nullptr);
+		CHECK(atlas.getOccupancy(0) == 1.0f);
+
+		// too big for any page, a doesn't even give up its space for that
+		CHECK(atlas.add("a", makeImage(256, 8, 60)) == nullptr);
+		CHECK(atlas.find("a") != nullptr);
+
+		CHECK(atlas.remove("b"));
+		CHECK(atlas.add("a", makeImage(96, 128, 70)) != nullptr);
+	}
+
+	void testAtlasAddsPages()
+	{
+		std::cout << "atlas adds pages up to maxPages" << std::endl;
+		TextureAtlas atlas(64, 0, 2);
+		CHECK(atlas.add("a", makeImage(64, 64, 10)) != nullptr);
+		const AtlasRegion* b = atlas.add("b", makeImage(64, 64, 20));
+		CHECK(b != nullptr && b->page == 1);
+		CHECK(atlas.getPageCount() == 2);
+		CHECK(atlas.add("c", makeImage(64, 64, 30)) == nullptr);
+		CHECK(atlas.getPageCount() == 2);
+		// not RGBA8
+		CHECK(atlas.add("d", Image(4, 4, PixelFormat::R8)) == nullptr);
+	}
+}
+
+int main()
+{
+	testPackerFillsTheBin();
+	testPackerReusesRemovedSpace();
+
+	if(createHeadlessContext())
+	{
+		testAtlasPacksWithPadding();
+		testAtlasReplace();
+		testAtlasFullPage();
+		testAtlasAddsPages();
+	}
+	else
+	{
+		std::cout << "no OpenGL context, skipping the TextureAtlas tests" << std::endl;
+	}
+
+	std::cout << (failures == 0 ? "all passed" : std::to_string(failures) + " checks failed") << std::endl;
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+/* TextureStreamer driven the way a draw loop drives it: textures ask for the size they are on screen,
+ * update() streams levels in, drops them when they're further away or not drawn anymore, and fits them
+ * into the pool. Needs a headless context, skipped without one */
+
+#include "HeadlessContext.h"
+#include "Image.h"
+#include "Texture.h"
+#include "TextureStreamer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+namespace
+{
+	int failures = 0;
+
+	#define CHECK(x) check((x), #x, __LINE__)
+
+	void check(bool passed, const char* what, int line)
+	{
+		if(passed)
+			return;
+		std::cout << "  FAILED line " << line << ": " << what << std::endl;
+		failures++;
+	}
+
+	// 512x512 has 10 levels, and with a tail of 64 the tail starts at level 3 (64x64)
+	constexpr int Size = 512;
+	constexpr int TailSize = 64;
+	constexpr int TailLevel = 3;
+
+	Image makeImage(unsigned char value)
+	{
+		Image image(Size, Size);
+		std::memset(image.getPixels(), value, image.getSize());
+		return image;
+	}
+
+	// what a quad of worldSize at distance covers in a 1080 pixel high viewport with a 60 degree fov
+	void drawAt(const Texture& texture, float worldSize, float distance)
+	{
+		const float size = getProjectedSize(worldSize, distance, 60.0f * 3.14159265f / 180.0f, 1080.0f);
+		texture.requestScreenSize(size, size);
+	}
+
+	void testProjectedSize()
+	{
+		std::cout << "projected size" << std::endl;
+		// a 90 degree fov sees 2 * distance units, so 2 units at distance 1 fill the viewport
+		CHECK(std::abs(getProjectedSize(2.0f, 1.0f, 3.14159265f / 2.0f, 600.0f) - 600.0f) < 0.01f);
+		CHECK(std::abs(getProjectedSize(2.0f, 2.0f, 3.14159265f / 2.0f, 600.0f) - 300.0f) < 0.01f);
+		// the camera inside it
+		CHECK(getProjectedSize(1.0f, 0.0f, 1.0f, 600.0f) == 600.0f);
+	}
+
+	void testStartsWithTheTail()
+	{
+		std::cout << "starts with the tail" << std::endl;
+		TextureStreamer streamer(64 * 1024 * 1024, TailSize);
+		std::shared_ptr<Texture> texture = streamer.add(makeImage(10));
+		CHECK(texture != nullptr && texture->isStreamed());
+		CHECK(texture->getResidentLevel() == TailLevel);
+		// not RGBA8
+		CHECK(streamer.add(Image(Size, Size, PixelFormat::R8)) == nullptr);
+		CHECK(streamer.getTextureCount() == 1);
+	}
+
+	void testStreamsInCoarseToFine()
+	{
+		std::cout << "streams in a level a frame, coarse to fine" << std::endl;
+		TextureStreamer streamer(64 * 1024 * 1024, TailSize);
+		std::shared_ptr<Texture> texture = streamer.add(makeImage(10));
+		for(int expected = TailLevel - 1; expected >= 0; expected--)
+		{
+			// close enough to want every texel
+			drawAt(*texture, 1.0f, 0.5f);
+			CHECK(streamer.update() == 1);
+			CHECK(texture->getResidentLevel() == expected);
+		}
+		drawAt(*texture, 1.0f, 0.5f);
+		CHECK(streamer.update() == 0);
+		CHECK(texture->getResidentLevel() == 0);
+	}
+
+	void testDropsWhenFurther()
+	{
+		std::cout << "drops levels when it's further away" << std::endl;
+		TextureStreamer streamer(64 * 1024 * 1024, TailSize);
+		std::shared_ptr<Texture> texture = streamer.add(makeImage(10));
+		for(int frame = 0; frame < TailLevel; frame++)
+		{
+			drawAt(*texture, 1.0f, 0.5f);
+			streamer.update();
+		}
+		CHECK(texture->getResidentLevel() == 0);
+		const size_t full = streamer.getResidentSize();
+
+		// about 130 pixels: 512 texels on those is level 1 by requestScreenSize's rounding down
+		drawAt(*texture, 1.0f, 7.2f);
+		streamer.update();
+		CHECK(texture->getResidentLevel() == 1);
+		CHECK(streamer.getResidentSize() < full);
+	}
+
+	void testDropsWhenNotDrawn()
+	{
+		std::cout << "goes back to the tail when not drawn" << std::endl;
+		const size_t keepFrames = 5;
+		TextureStreamer streamer(64 * 1024 * 1024, TailSize, keepFrames);
+		std::shared_ptr<Texture> texture = streamer.add(makeImage(10));
+		for(int frame = 0; frame < TailLevel; frame++)
+		{
+			drawAt(*texture, 1.0f, 0.5f);
+			streamer.update();
+		}
+		CHECK(texture->getResidentLevel() == 0);
+
+		for(size_t frame = 0; frame < keepFrames; frame++)
+			streamer.update();
+		CHECK(texture->getResidentLevel() == 0); // behind the camera for a moment, the levels stay
+		streamer.update();
+		CHECK(texture->getResidentLevel() == TailLevel);
+	}
+
+	void testUploadBudget()
+	{
+		std::cout << "keeps to the upload budget" << std::endl;
+		TextureStreamer streamer(64 * 1024 * 1024, TailSize);
+		std::shared_ptr<Texture> a = streamer.add(makeImage(10));
+		std::shared_ptr<Texture> b = streamer.add(makeImage(20));
+		drawAt(*a, 1.0f, 0.5f);
+		drawAt(*b, 1.0f, 0.5f);
+		// level 2 is 128x128, 64 KB: one fits, both don't
+		CHECK(streamer.update(100 * 1024) == 1);
+		CHECK(std::min(a->getResidentLevel(), b->getResidentLevel()) == TailLevel - 1);
+		CHECK(std::max(a->getResidentLevel(), b->getResidentLevel()) == TailLevel);
+		// a level larger than the whole budget still goes in, alone
+		drawAt(*a, 1.0f, 0.5f);
+		drawAt(*b, 1.0f, 0.5f);
+		CHECK(streamer.update(1) == 1);
+	}
+
+	void testPoolPressure()
+	{
+		std::cout << "fits the pool by giving up the largest levels" << std::endl;
+		const size_t tail = Texture::getLevelSize(Size, Size, TailLevel) * 4 / 3 + 64; // levels 3 to 9
+		const size_t level0 = Texture::getLevelSize(Size, Size, 0);
+		const size_t level1 = Texture::getLevelSize(Size, Size, 1);
+		const size_t level2 = Texture::getLevelSize(Size, Size, 2);
+		// room for one of them to have every level, the other gets all but level 0
+		const size_t poolSize = 2 * (tail + level2 + level1) + level0;
+		TextureStreamer streamer(poolSize, TailSize);
+		std::shared_ptr<Texture> a = streamer.add(makeImage(10));
+		std::shared_ptr<Texture> b = streamer.add(makeImage(20));
+		for(int frame = 0; frame < 2 * TailLevel; frame++)
+		{
+			drawAt(*a, 1.0f, 0.5f);
+			drawAt(*b, 1.0f, 0.5f);
+			streamer.update();
+			CHECK(streamer.getResidentSize() <= poolSize);
+		}
+		CHECK(std::min(a->getResidentLevel(), b->getResidentLevel()) == 0);
+		CHECK(std::max(a->getResidentLevel(), b->getResidentLevel()) == 1);
+
+		// a smaller pool takes the levels away from both alike
+		streamer.setPoolSize(2 * (tail + level2));
+		drawAt(*a, 1.0f, 0.5f);
+		drawAt(*b, 1.0f, 0.5f);
+		streamer.update();
+		CHECK(a->getResidentLevel() == 2 && b->getResidentLevel() == 2);
+		CHECK(streamer.getResidentSize() <= streamer.getPoolSize());
+
+		// and no pool at all leaves the tails, never less
+		streamer.setPoolSize(0);
+		drawAt(*a, 1.0f, 0.5f);
+		streamer.update();
+		CHECK(a->getResidentLevel() == TailLevel && b->getResidentLevel() == TailLevel);
+
+		streamer.remove(a);
+		CHECK(streamer.getTextureCount() == 1);
+	}
+}
+
+int main()
+{
+	testProjectedSize();
+
+	if(createHeadlessContext())
+	{
+		testStartsWithTheTail();
+		testStreamsInCoarseToFine();
+		testDropsWhenFurther();
+		testDropsWhenNotDrawn();
+		testUploadBudget();
+		testPoolPressure();
+	}
+	else
+	{
+		std::cout << "no OpenGL context, skipping the TextureStreamer tests" << std::endl;
+	}
+
+	std::cout << (failures == 0 ? "all passed" : std::to_string(failures) + " checks failed") << std::endl;
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,356 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+/* Build step that packs .shader files into one shaders.pack (see ShaderPack.h for the layout).
+ *
+ *   ShaderPacker <output.pack> <file.shader>... [--binaries] [--spirv <dir>]
+ *   ShaderPacker --split <dir> <file.shader>...
+ *
+ * Every shader is split into vertex and fragment source, its #include "file" lines are resolved
+ * (relative to the file that includes them) and it is checked before it goes in.
+ * With --binaries we also open a hidden window, compile and link every shader and store
+ * the program binary, so that the app doesn't have to compile on this machine's driver at all.
+ * With --spirv, <dir>/<name>.vert.spv and <name>.frag.spv are stored next to the sources when they exist.
+ *
+ * --split only writes the checked and preprocessed stages to <dir>/<name>.vert and <name>.frag,
+ * which is what glslangValidator compiles to SPIR-V in the build.
+ * */
+
+#include "GL/glew.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "Renderer.h"
+#include "Shader.h"
+#include "ShaderPack.h"
+
+struct PackedShader
+{
+	std::string name;
+	std::string vertexSource;
+	std::string fragmentSource;
+	unsigned int binaryFormat = 0;
+	std::vector<unsigned char> binary;
+	std::vector<unsigned char> spirvVertex;
+	std::vector<unsigned char> spirvFragment;
+};
+
+static bool preprocess(const std::filesystem::path& file, const std::string& source, std::string& output, int depth)
+{
+	if(depth > 16)
+	{
+		std::cout << file.string() << ": #include nested too deep" << std::endl;
+		return false;
+	}
+
+	std::istringstream stream(source);
+	std::string line;
+	int lineNumber = 0;
+	while(getline(stream, line))
+	{
+		lineNumber++;
+		size_t directive = line.find("#include");
+		if(directive == std::string::npos)
+		{
+			output += line;
+			output += '\n';
+			continue;
+		}
+
+		size_t open = line.find('"', directive);
+		size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+		if(close == std::string::npos)
+		{
+			std::cout << file.string() << ":" << lineNumber << ": expected #include \"file\"" << std::endl;
+			return false;
+		}
+
+		std::filesystem::path included = file.parent_path() / line.substr(open + 1, close - open - 1);
+		std::ifstream includedStream(included);
+		if(!includedStream)
+		{
+			std::cout << file.string() << ":" << lineNumber << ": can't open " << included.string() << std::endl;
+			return false;
+		}
+		std::stringstream includedSource;
+		includedSource << includedStream.rdbuf();
+		if(!preprocess(included, includedSource.str(), output, depth + 1))
+			return false;
+	}
+	return true;
+}
+
+static bool validateStage(const std::string& file, const char* stage, const std::string& source)
+{
+	if(source.find_first_not_of(" \t\r\n") == std::string::npos)
+	{
+		std::cout << file << ": no " << stage << " shader (missing '#shader " << stage << "'?)" << std::endl;
+		return false;
+	}
+
+	// glsl wants #version before anything else but comments and whitespace
+	size_t first = source.find_first_not_of(" \t\r\n");
+	if(source.compare(first, 8, "#version") != 0)
+	{
+		std::cout << file << ": the " << stage << " shader has to start with #version" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+static bool storeBinaries(std::vector<PackedShader>& shaders, std::string& driver)
+{
+	if(!glfwInit())
+		return false;
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "ShaderPacker", nullptr, nullptr);
+	if(!window)
+	{
+		glfwTerminate();
+		return false;
+	}
+	glfwMakeContextCurrent(window);
+
+	bool ok = glewInit() == GLEW_OK;
+	if(ok && !GLEW_ARB_get_program_binary)
+		std::cout << "Warning: this driver can't give us program binaries, packing sources only" << std::endl;
+
+	if(ok)
+		driver = ShaderPack::getCurrentDriver();
+
+	for(PackedShader& packed : shaders)
+	{
+		if(!ok)
+			break;
+
+		// the Shader is destroyed at the end of the scope, after we took its binary
+		Shader shader(packed.name, packed.vertexSource, packed.fragmentSource);
+		if(!shader.isLinked())
+		{
+			std::cout << packed.name << ": failed to link" << std::endl;
+			ok = false;
+			break;
+		}
+
+		if(!GLEW_ARB_get_program_binary)
+			continue;
+
+		int length = 0;
+		glCall(glGetProgramiv(shader.getRendererID(), GL_PROGRAM_BINARY_LENGTH, &length));
+		packed.binary.resize(length);
+		GLenum format = 0;
+		if(length > 0)
+		{
+			glCall(glGetProgramBinary(shader.getRendererID(), length, &length, &format, packed.binary.data()));
+		}
+		packed.binary.resize(length);
+		packed.binaryFormat = format;
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return ok;
+}
+
+static uint32_t append(std::vector<unsigned char>& data, const void* bytes, size_t length, bool terminate)
+{
+	// keep everything 4 byte aligned, SPIR-V is an array of 32 bit words
+	while(data.size() % 4 != 0)
+		data.push_back('\0');
+
+	uint32_t offset = data.size();
+	const auto* begin = static_cast<const unsigned char*>(bytes);
+	data.insert(data.end(), begin, begin + length);
+	if(terminate)
+		data.push_back('\0');
+	return offset;
+}
+
+static bool writePack(const std::string& outputPath, std::vector<PackedShader>& shaders, const std::string& driver)
+{
+	// the app looks shaders up with a binary search
+	std::sort(shaders.begin(), shaders.end(),
+			[](const PackedShader& a, const PackedShader& b) { return a.name < b.name; });
+
+	ShaderPackHeader header{};
+	std::memcpy(header.magic, "SPAK", 4);
+	header.version = ShaderPackVersion;
+	header.entryCount = shaders.size();
+
+	std::vector<ShaderPackEntry> entries(shaders.size());
+	std::vector<unsigned char> data;
+	const size_t dataStart = sizeof(ShaderPackHeader) + sizeof(ShaderPackEntry) * entries.size();
+
+	header.driverOffset = dataStart + append(data, driver.data(), driver.size(), true);
+	header.driverLength = driver.size();
+
+	for(size_t i = 0; i < shaders.size(); i++)
+	{
+		const PackedShader& packed = shaders[i];
+		ShaderPackEntry& entry = entries[i];
+		entry.nameOffset = dataStart + append(data, packed.name.data(), packed.name.size(), true);
+		entry.nameLength = packed.name.size();
+		entry.vertexOffset = dataStart + append(data, packed.vertexSource.data(), packed.vertexSource.size(), true);
+		entry.vertexLength = packed.vertexSource.size();
+		entry.fragmentOffset = dataStart + append(data, packed.fragmentSource.data(), packed.fragmentSource.size(), true);
+		entry.fragmentLength = packed.fragmentSource.size();
+		entry.binaryFormat = packed.binaryFormat;
+		entry.binaryOffset = dataStart + append(data, packed.binary.data(), packed.binary.size(), false);
+		entry.binaryLength = packed.binary.size();
+		entry.spirvVertexOffset = dataStart + append(data, packed.spirvVertex.data(), packed.spirvVertex.size(), false);
+		entry.spirvVertexLength = packed.spirvVertex.size();
+		entry.spirvFragmentOffset = dataStart + append(data, packed.spirvFragment.data(), packed.spirvFragment.size(), false);
+		entry.spirvFragmentLength = packed.spirvFragment.size();
+	}
+
+	std::ofstream stream(outputPath, std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	stream.write(reinterpret_cast<const char*>(entries.data()), sizeof(ShaderPackEntry) * entries.size());
+	stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+	return static_cast<bool>(stream);
+}
+
+static bool loadShader(const std::filesystem::path& file, PackedShader& packed)
+{
+	if(!std::filesystem::exists(file))
+	{
+		std::cout << file.string() << ": doesn't exist" << std::endl;
+		return false;
+	}
+
+	packed.name = file.stem().string();
+	ShaderProgramSource source = Shader::parseShader(file.string());
+	return preprocess(file, source.vertexSource, packed.vertexSource, 0)
+		&& preprocess(file, source.fragmentSource, packed.fragmentSource, 0)
+		&& validateStage(file.string(), "vertex", packed.vertexSource)
+		&& validateStage(file.string(), "fragment", packed.fragmentSource);
+}
+
+static bool readFile(const std::filesystem::path& file, std::vector<unsigned char>& bytes)
+{
+	std::ifstream stream(file, std::ios::binary);
+	if(!stream)
+		return false;
+	bytes.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	return true;
+}
+
+static bool writeFile(const std::filesystem::path& file, const std::string& text)
+{
+	std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+	stream << text;
+	return static_cast<bool>(stream);
+}
+
+static int split(const std::filesystem::path& directory, int fileCount, char** files)
+{
+	std::filesystem::create_directories(directory);
+	for(int i = 0; i < fileCount; i++)
+	{
+		PackedShader packed;
+		if(!loadShader(files[i], packed))
+			return 1;
+
+		if(!writeFile(directory / (packed.name + ".vert"), packed.vertexSource)
+			|| !writeFile(directory / (packed.name + ".frag"), packed.fragmentSource))
+		{
+			std::cout << "Failed to write the stages of " << packed.name << " to " << directory.string() << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc >= 3 && std::strcmp(argv[1], "--split") == 0)
+		return split(argv[2], argc - 3, argv + 3);
+
+	if(argc < 2)
+	{
+		std::cout << "usage: " << argv[0] << " <output.pack> <file.shader>... [--binaries] [--spirv <dir>]" << std::endl;
+		std::cout << "       " << argv[0] << " --split <dir> <file.shader>..." << std::endl;
+		return 1;
+	}
+
+	std::string outputPath = argv[1];
+	bool binaries = false;
+	std::filesystem::path spirvDirectory;
+	std::vector<PackedShader> shaders;
+	bool ok = true;
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(std::strcmp(argv[i], "--binaries") == 0)
+		{
+			binaries = true;
+			continue;
+		}
+		if(std::strcmp(argv[i], "--spirv") == 0 && i + 1 < argc)
+		{
+			spirvDirectory = argv[++i];
+			continue;
+		}
+
+		PackedShader packed;
+		if(!loadShader(argv[i], packed))
+		{
+			ok = false;
+			continue;
+		}
+
+		for(const PackedShader& other : shaders)
+		{
+			if(other.name == packed.name)
+			{
+				std::cout << argv[i] << ": there is already a shader called " << packed.name << std::endl;
+				ok = false;
+			}
+		}
+		shaders.push_back(std::move(packed));
+	}
+
+	if(!spirvDirectory.empty())
+	{
+		/* a shader with only one of its stages in SPIR-V can't use that path, so we want both or neither */
+		for(PackedShader& packed : shaders)
+		{
+			if(!readFile(spirvDirectory / (packed.name + ".vert.spv"), packed.spirvVertex)
+				|| !readFile(spirvDirectory / (packed.name + ".frag.spv"), packed.spirvFragment))
+			{
+				std::cout << "Warning: no SPIR-V for " << packed.name << ", packing GLSL only" << std::endl;
+				packed.spirvVertex.clear();
+				packed.spirvFragment.clear();
+			}
+		}
+	}
+
+	std::string driver;
+	if(ok && binaries && !storeBinaries(shaders, driver))
+	{
+		std::cout << "Failed to compile the shaders for their binaries" << std::endl;
+		ok = false;
+	}
+
+	if(!ok)
+		return 1;
+
+	if(!writePack(outputPath, shaders, driver))
+	{
+		std::cout << "Failed to write " << outputPath << std::endl;
+		return 1;
+	}
+
+	std::cout << "Packed " << shaders.size() << " shader(s) into " << outputPath << std::endl;
+	return 0;
+}
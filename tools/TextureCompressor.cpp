@@ -0,0 +1,100 @@
+//
+// Created by naveen on 19/10/26.
+//
+
+/* Offline texture compression. Turns pngs (or anything stb_image reads) into block compressed .dds files
+ * with a full mip chain, so the app uploads them as they are and they take 4 to 8 times less VRAM.
+ *
+ *   TextureCompressor <output dir> <image>... [--format auto|bc1|bc3|bc4|bc5] [--no-mips]
+ *
+ * auto picks BC3 for images that use their alpha channel and BC1 for the rest. The mip levels of
+ * color textures are averaged gamma correctly (see Mipmap.h).
+ * No opengl context is needed, this runs anywhere.
+ * */
+
+#include "BlockCompression.h"
+#include "CompressedImage.h"
+#include "Image.h"
+#include "Mipmap.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static unsigned int parseFormat(const std::string& name)
+{
+	if(name == "bc1") return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	if(name == "bc3") return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	if(name == "bc4") return GL_COMPRESSED_RED_RGTC1;
+	if(name == "bc5") return GL_COMPRESSED_RG_RGTC2;
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 3)
+	{
+		std::cout << "usage: " << argv[0] << " <output dir> <image>... [--format auto|bc1|bc3|bc4|bc5] [--no-mips]" << std::endl;
+		return 1;
+	}
+
+	std::filesystem::path outputDirectory = argv[1];
+	std::string formatName = "auto";
+	bool mips = true;
+	std::vector<std::filesystem::path> inputs;
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(std::strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+			formatName = argv[++i];
+		else if(std::strcmp(argv[i], "--no-mips") == 0)
+			mips = false;
+		else
+			inputs.emplace_back(argv[i]);
+	}
+
+	if(formatName != "auto" && parseFormat(formatName) == 0)
+	{
+		std::cout << "unknown format '" << formatName << "'" << std::endl;
+		return 1;
+	}
+
+	std::filesystem::create_directories(outputDirectory);
+	int failed = 0;
+	for(const std::filesystem::path& input : inputs)
+	{
+		Image image(input.string());
+		if(!image.isValid())
+		{
+			std::cout << input.string() << ": can't read it" << std::endl;
+			failed++;
+			continue;
+		}
+
+		unsigned int format = formatName == "auto"
+			? (image.hasAlpha() ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT)
+			: parseFormat(formatName);
+
+		/* gamma correct, except for BC4 and BC5 which are usually data like normals and heights, not colors */
+		const bool gammaCorrect = format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT || format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		std::vector<Image> mipLevels;
+		if(mips)
+			mipLevels = generateMipChain(image, gammaCorrect, std::max(1u, std::thread::hardware_concurrency()));
+		CompressedImage compressed = compressImage(image, mipLevels, format);
+
+		std::filesystem::path output = outputDirectory / input.filename().replace_extension(".dds");
+		if(!compressed.writeDDS(output.string()))
+		{
+			std::cout << output.string() << ": failed to write" << std::endl;
+			failed++;
+			continue;
+		}
+		std::cout << input.string() << " -> " << output.string() << " (" << compressed.getLevelCount() << " levels, "
+				  << compressed.getSize() / 1024 << " KB)" << std::endl;
+	}
+	return failed == 0 ? 0 : 1;
+}